@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "hdc1080.h"
+#include "hdc1080_sim.h"
+
+#define BENCH_SAMPLES           (200)                   /* SAMPLES PER CONFIGURATION FOR LATENCY AND BUS COST */
+#define BENCH_RATE_WINDOW       (1000000)               /* MICROSECONDS TO RUN THE SAMPLE RATE TEST */
+#define BENCH_CPU_BATCH         (4096)                  /* SAMPLES PER CPU TIMING PASS */
+#define BENCH_CPU_PASSES        (64)                    /* PASSES PER CPU TIMING */
+#define BENCH_TIMEOUT           ((TickType_t)200 / portTICK_PERIOD_MS)
+
+/* THE LINKER IS TOLD TO WRAP THE ALLOCATORS, SEE main/CMakeLists.txt,
+ * EVERY CALL IS COUNTED SO ALLOCATIONS PER SAMPLE CAN BE REPORTED */
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t count, size_t size);
+void * __real_realloc(void * ptr, size_t size);
+static atomic_uint heap_allocations;
+void * __wrap_malloc(size_t size){ atomic_fetch_add(&heap_allocations, 1); return __real_malloc(size); }
+void * __wrap_calloc(size_t count, size_t size){ atomic_fetch_add(&heap_allocations, 1); return __real_calloc(count, size); }
+void * __wrap_realloc(void * ptr, size_t size){ atomic_fetch_add(&heap_allocations, 1); return __real_realloc(ptr, size); }
+
+/* ONE ROW OF THE SWEEP */
+typedef struct BENCH_CASE {
+  const char * name;
+  unsigned char temperature_resolution;
+  unsigned char humidity_resolution;
+  unsigned char mode_of_acquisition;
+  unsigned char completion_mode;
+  unsigned char channel;
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+  { "T14 H14 BOTH TIMED", HDC1080_TEMPERATURE_RESOLUTION_14BIT, HDC1080_HUMIDITY_RESOLUTION_14BIT, HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE, HDC1080_COMPLETION_TIMED, HDC1080_CHANNEL_BOTH },
+  { "T14 H14 BOTH POLL ", HDC1080_TEMPERATURE_RESOLUTION_14BIT, HDC1080_HUMIDITY_RESOLUTION_14BIT, HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE, HDC1080_COMPLETION_POLL, HDC1080_CHANNEL_BOTH },
+  { "T11 H11 BOTH TIMED", HDC1080_TEMPERATURE_RESOLUTION_11BIT, HDC1080_HUMIDITY_RESOLUTION_11BIT, HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE, HDC1080_COMPLETION_TIMED, HDC1080_CHANNEL_BOTH },
+  { "T11 H11 BOTH POLL ", HDC1080_TEMPERATURE_RESOLUTION_11BIT, HDC1080_HUMIDITY_RESOLUTION_11BIT, HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE, HDC1080_COMPLETION_POLL, HDC1080_CHANNEL_BOTH },
+  { "T11 H8  BOTH TIMED", HDC1080_TEMPERATURE_RESOLUTION_11BIT, HDC1080_HUMIDITY_RESOLUTION_8BIT, HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE, HDC1080_COMPLETION_TIMED, HDC1080_CHANNEL_BOTH },
+  { "T11 H8  BOTH POLL ", HDC1080_TEMPERATURE_RESOLUTION_11BIT, HDC1080_HUMIDITY_RESOLUTION_8BIT, HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE, HDC1080_COMPLETION_POLL, HDC1080_CHANNEL_BOTH },
+  { "T14 H14 SEP  TIMED", HDC1080_TEMPERATURE_RESOLUTION_14BIT, HDC1080_HUMIDITY_RESOLUTION_14BIT, HDC1080_ACQUISITION_HUMIDITY_OR_TEMPERATURE, HDC1080_COMPLETION_TIMED, HDC1080_CHANNEL_BOTH },
+  { "T14 ONLY     TIMED", HDC1080_TEMPERATURE_RESOLUTION_14BIT, HDC1080_HUMIDITY_RESOLUTION_14BIT, HDC1080_ACQUISITION_HUMIDITY_OR_TEMPERATURE, HDC1080_COMPLETION_TIMED, HDC1080_CHANNEL_TEMPERATURE },
+  { "T14 ONLY     POLL ", HDC1080_TEMPERATURE_RESOLUTION_14BIT, HDC1080_HUMIDITY_RESOLUTION_14BIT, HDC1080_ACQUISITION_HUMIDITY_OR_TEMPERATURE, HDC1080_COMPLETION_POLL, HDC1080_CHANNEL_TEMPERATURE },
+  { "T11 ONLY     POLL ", HDC1080_TEMPERATURE_RESOLUTION_11BIT, HDC1080_HUMIDITY_RESOLUTION_8BIT, HDC1080_ACQUISITION_HUMIDITY_OR_TEMPERATURE, HDC1080_COMPLETION_POLL, HDC1080_CHANNEL_TEMPERATURE },
+  { "H8  ONLY     POLL ", HDC1080_TEMPERATURE_RESOLUTION_11BIT, HDC1080_HUMIDITY_RESOLUTION_8BIT, HDC1080_ACQUISITION_HUMIDITY_OR_TEMPERATURE, HDC1080_COMPLETION_POLL, HDC1080_CHANNEL_HUMIDITY },
+};
+
+static SemaphoreHandle_t sample_done = NULL;
+static int64_t sample_received = 0;
+
+static void bench_sensor(hdc1080_sim_handle_t sim, const bench_case_t * bench);
+static void bench_cpu(void);
+
+/* THE BENCHMARK CALLBACK ONLY STAMPS THE ARRIVAL TIME */
+static void bench_readings_callback(hdc1080_sensor_readings_t sens_readings, void * user_ctx){
+  sample_received = esp_timer_get_time();
+  xSemaphoreGive(sample_done);
+}
+
+void app_main(void){
+  hdc1080_sim_handle_t sim = NULL;
+  sample_done = xSemaphoreCreateBinary();
+  // THE DRIVER LOGS EVERY CONVERSION AT INFO, KEEP IT OUT OF THE TIMINGS
+  esp_log_level_set("HDC1080", ESP_LOG_WARN);
+  // ONE SIMULATED HDC1080 ON A 400kHz BUS
+  ESP_ERROR_CHECK(hdc1080_sim_create(400000, &sim));
+  hdc1080_sim_device_config_t device_config = {
+    .i2c_address = HDC1080_I2C_ADDRESS,
+    .mux_address = HDC1080_SIM_NO_MUX,
+    .serial_id = 0x0123456789ULL
+  };
+  ESP_ERROR_CHECK(hdc1080_sim_add_device(sim, &device_config, NULL));
+
+  printf("\nPER SAMPLE COST, %d SAMPLES PER CONFIGURATION\n", BENCH_SAMPLES);
+  printf("%-20s %9s %9s %9s %8s %8s %8s %9s %10s\n", "CONFIGURATION", "LAT MIN", "LAT AVG", "LAT MAX", "TX/S", "BYTES/S", "BUS uS/S", "ALLOCS/S", "MAX RATE");
+  for(size_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++){
+    bench_sensor(sim, &bench_cases[i]);
+  }
+  bench_cpu();
+  hdc1080_sim_delete(sim);
+  exit(0);
+}
+
+/* ----------------------------------------------------------------------
+ * @name static void bench_sensor(hdc1080_sim_handle_t sim, const bench_case_t * bench)
+ * ----------------------------------------------------------------------
+ * @brief Configure the simulated sensor for one case and print the
+ * request to callback latency, the bus traffic and allocations per
+ * sample and the highest back to back sample rate
+ */
+static void bench_sensor(hdc1080_sim_handle_t sim, const bench_case_t * bench){
+  hdc1080_handle_t hdc_handle = NULL;
+  hdc1080_settings_t hdc_settings = {
+    .i2c_address = HDC1080_I2C_ADDRESS,
+    .timeout_length = BENCH_TIMEOUT,
+    .callback = bench_readings_callback,
+    .completion_mode = bench->completion_mode,
+    .channel = bench->channel
+  };
+  hdc1080_sim_get_bus(sim, &hdc_settings.bus);
+  hdc1080_config_t hdc_config = {
+    .humidity_measurement_resolution = bench->humidity_resolution,
+    .temperature_measurement_resolution = bench->temperature_resolution,
+    .mode_of_acquisition = bench->mode_of_acquisition,
+    .heater = HDC1080_HEATER_DISABLED
+  };
+  if(hdc1080_configure(&hdc_settings, hdc_config, &hdc_handle) != ESP_OK){
+    printf("%-20s CONFIGURATION FAILED\n", bench->name);
+    return;
+  }
+
+  // LATENCY, BUS COST AND ALLOCATIONS OF SINGLE REQUESTS
+  int64_t latency_min = INT64_MAX, latency_max = 0, latency_sum = 0;
+  unsigned int allocations = 0;
+  hdc1080_sim_stats_t sim_stats;
+  hdc1080_sim_reset_stats(sim);
+  for(int i = 0; i < BENCH_SAMPLES; i++){
+    unsigned int allocations_before = atomic_load(&heap_allocations);
+    int64_t requested = esp_timer_get_time();
+    if(hdc1080_request_readings(hdc_handle) != ESP_OK || xSemaphoreTake(sample_done, BENCH_TIMEOUT) != pdTRUE){
+      printf("%-20s REQUEST FAILED\n", bench->name);
+      hdc1080_delete(hdc_handle);
+      return;
+    }
+    allocations += atomic_load(&heap_allocations) - allocations_before;
+    int64_t latency = sample_received - requested;
+    latency_sum += latency;
+    if(latency < latency_min){ latency_min = latency; }
+    if(latency > latency_max){ latency_max = latency; }
+  }
+  hdc1080_sim_get_stats(sim, &sim_stats);
+
+  // HIGHEST SUSTAINABLE RATE, EACH REQUEST STARTS AS SOON AS THE LAST ONE IS DELIVERED
+  hdc1080_sensor_readings_t sens_readings;
+  unsigned int samples = 0;
+  int64_t window_end = esp_timer_get_time() + BENCH_RATE_WINDOW;
+  while(esp_timer_get_time() < window_end){
+    if(hdc1080_read_sync(hdc_handle, &sens_readings, BENCH_TIMEOUT) == ESP_OK){ samples++; }
+  }
+
+  printf("%-20s %7lldus %7lldus %7lldus %8.2f %8.2f %8.1f %9.2f %8.1fHz\n", bench->name,
+    (long long)latency_min, (long long)(latency_sum / BENCH_SAMPLES), (long long)latency_max,
+    (float)sim_stats.transactions / BENCH_SAMPLES, (float)(sim_stats.bytes_written + sim_stats.bytes_read) / BENCH_SAMPLES,
+    (float)sim_stats.bus_time / BENCH_SAMPLES, (float)allocations / BENCH_SAMPLES,
+    (float)samples * 1000000 / BENCH_RATE_WINDOW);
+  hdc1080_delete(hdc_handle);
+}
+
+/* ----------------------------------------------------------------------
+ * @name static void bench_cpu(void)
+ * ----------------------------------------------------------------------
+ * @brief Time the conversion and derived metric code per sample
+ */
+static void bench_cpu(void){
+  static hdc1080_raw_readings_t raw[BENCH_CPU_BATCH];
+  static hdc1080_fixed_readings_t fixed[BENCH_CPU_BATCH];
+  static hdc1080_sensor_readings_t readings[BENCH_CPU_BATCH];
+  static hdc1080_psychro_t psychro[BENCH_CPU_BATCH];
+  static hdc1080_psychro_fixed_t psychro_fixed[BENCH_CPU_BATCH];
+  // SPREAD THE CODES OVER THE WHOLE RANGE
+  for(int i = 0; i < BENCH_CPU_BATCH; i++){
+    raw[i].temperature = (unsigned short)(i * 16);
+    raw[i].humidity = (unsigned short)(65535 - (i * 16));
+  }
+  printf("\nCPU COST PER SAMPLE, %d PASSES OF %d SAMPLES\n", BENCH_CPU_PASSES, BENCH_CPU_BATCH);
+
+  int64_t started = esp_timer_get_time();
+  for(int pass = 0; pass < BENCH_CPU_PASSES; pass++){
+    hdc1080_raw_to_float(raw, readings, BENCH_CPU_BATCH);
+  }
+  printf("%-36s %8.2fns\n", "RAW -> FLOAT (hdc1080_raw_to_float)", (float)(esp_timer_get_time() - started) * 1000 / (BENCH_CPU_PASSES * BENCH_CPU_BATCH));
+
+  started = esp_timer_get_time();
+  for(int pass = 0; pass < BENCH_CPU_PASSES; pass++){
+    hdc1080_raw_to_fixed(raw, fixed, BENCH_CPU_BATCH);
+  }
+  printf("%-36s %8.2fns\n", "RAW -> FIXED (hdc1080_raw_to_fixed)", (float)(esp_timer_get_time() - started) * 1000 / (BENCH_CPU_PASSES * BENCH_CPU_BATCH));
+
+  started = esp_timer_get_time();
+  for(int pass = 0; pass < BENCH_CPU_PASSES; pass++){
+    hdc1080_psychro_batch(readings, psychro, BENCH_CPU_BATCH);
+  }
+  printf("%-36s %8.2fns\n", "PSYCHRO FLOAT", (float)(esp_timer_get_time() - started) * 1000 / (BENCH_CPU_PASSES * BENCH_CPU_BATCH));
+
+  started = esp_timer_get_time();
+  for(int pass = 0; pass < BENCH_CPU_PASSES; pass++){
+    hdc1080_psychro_batch_fixed(fixed, psychro_fixed, BENCH_CPU_BATCH);
+  }
+  printf("%-36s %8.2fns\n", "PSYCHRO FIXED", (float)(esp_timer_get_time() - started) * 1000 / (BENCH_CPU_PASSES * BENCH_CPU_BATCH));
+}
@@ -11,6 +11,7 @@
 #define I2C_READ_TIMEOUT_PERIOD   ((TickType_t)200 / portTICK_PERIOD_MS)
 
 static bool i2c_init(void);
+static hdc1080_handle_t hdc_handle = NULL;
 
 /* THIS IS THE CALLBACK FOR THE SENSOR READINGS,
  * THE HDC1080 REQUIRES A SHORT CONVERSION PERIOD
@@ -18,7 +19,7 @@ static bool i2c_init(void);
  * A TIMER IS STARTED WHEN THE CONVERSION IS FINISHED
  * THE VALUES ARE READ AND THEN RETURNED TO THIS CALLBACK 
  * ON COMPLETE. IF BOTH VALUES ARE 0 THEN AN ERROR MAY HAVE OCCURED */
-void temperature_readings_callback(hdc1080_sensor_readings_t sens_readings){
+void temperature_readings_callback(hdc1080_sensor_readings_t sens_readings, void * user_ctx){
   /* HERE ARE SOME CONVERSION SAMPLES, THE MACROS ARE LOCATED IN hdc1080.h */
   float temp_in_f = CEL2FAH(sens_readings.temperature);
   float dewpoint = DEWPOINT(sens_readings.temperature, sens_readings.humidity);
@@ -39,7 +40,9 @@ void app_main(void){
       .i2c_address = HDC1080_I2C_ADDRESS,
       .i2c_port_number = CONFIG_HDC1080_I2C_PORT_NUMBER,
       .timeout_length = I2C_READ_TIMEOUT_PERIOD,
-      .callback = temperature_readings_callback
+      .callback = temperature_readings_callback,
+      .user_ctx = NULL,
+      .completion_mode = HDC1080_COMPLETION_TIMED
     };
     
     // SETUP YOUR HDC REGISTER CONFIGURATION
@@ -50,13 +53,13 @@ void app_main(void){
       .heater = HDC1080_HEATER_DISABLED
     };
 
-    // SETUP AND CONFIGURE THE SENSOR AND ABSTRACTION
-    if(hdc1080_configure(&hdc_settings, hdc_config) == ESP_OK){
+    // SETUP AND CONFIGURE THE SENSOR AND ABSTRACTION, EACH SENSOR GETS ITS OWN HANDLE
+    if(hdc1080_configure(&hdc_settings, hdc_config, &hdc_handle) == ESP_OK){
       ESP_LOGI("MAIN", "HDC1080 CONFIGURATION SUCCESSFUL");
       // DO A REQUEST FOR THE SENSOR READINGS 
-      // THIS WILL CALLBACK TO void temperature_readings_callback(hdc1080_sensor_readings_t sens_readings)
+      // THIS WILL CALLBACK TO void temperature_readings_callback(hdc1080_sensor_readings_t sens_readings, void * user_ctx)
       // AS SET IN THE hdc_settings
-      if(hdc1080_request_readings() == ESP_OK){
+      if(hdc1080_request_readings(hdc_handle) == ESP_OK){
         ESP_LOGI("MAIN", "READINGS WERE REQUESTED");
       }
     }
@@ -64,10 +67,10 @@ void app_main(void){
     // AS AN EXAMPLE, ANYTIME READINGS HAVE BEEN REQUESTED AND CONVERSION HAS STARTED
     // ANYTHING CALLED WILL RETURN IN AN ERROR HDC1080_CONVERTING, A WAIT AND CHECK
     // FUNCTION WILL BE REQURED BEFORE THE NEXT COMMAND CAN BE RUN
-    // THE WAIT PERIOD CAN BE ADJUSTED IN THE hdc1080.h FILE, HDC1080_CONVERSION_WAIT_PERIOD
-    // THE VALUE IS IN MICROSECONDS. MINIMUM WAIT TIME IS 6.8uS HOWEVER THE DEFAULT IS 1/2 SECOND
-    // SINCE READS SHOULD ONLY OCCUR > ONCE A SECOND FOR STABILITY
-    esp_err_t gcfg = hdc1080_get_configuration(&hdc_config);
+    // THE WAIT PERIOD IS WORKED OUT FROM THE CONFIGURED RESOLUTIONS, SEE hdc1080_conversion_time
+    // AT 14 BIT TEMPERATURE AND HUMIDITY IT IS ROUGHLY 14mS. SET .completion_mode TO
+    // HDC1080_COMPLETION_POLL TO HAVE THE READINGS DELIVERED AS SOON AS THE SENSOR HAS THEM
+    esp_err_t gcfg = hdc1080_get_configuration(hdc_handle, &hdc_config);
     if(gcfg == HDC1080_CONVERTING){
       ESP_LOGE("MAIN", "REQUEST FAILED, CONVERSION IN PROGRESS");
     }
@@ -9,201 +9,2043 @@
  *
  */
 #include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <sdkconfig.h>
 #include <esp_timer.h>
+#if !CONFIG_IDF_TARGET_LINUX
+#include <esp_system.h>
 #include <driver/i2c.h>
+#endif
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
 #include "hdc1080.h"
 
-static esp_err_t read_hdc100_data(unsigned char i2c_register, unsigned char * read_buff, size_t read_len);
-static esp_err_t write_hdc100_data(unsigned char i2c_register, unsigned char * write_buff, size_t write_len);
-static esp_err_t check_hdc1080_error(esp_err_t hdc_err);
+ESP_EVENT_DEFINE_BASE(HDC1080_EVENT);
+
+#if !CONFIG_IDF_TARGET_LINUX
+/* ROOM FOR START, ADDRESS, DATA, REPEATED START, ADDRESS, DATA AND STOP */
+#define HDC1080_CMD_LINK_SIZE   I2C_LINK_RECOMMENDED_SIZE(2)
+#endif
+#define HDC1080_MAX_WRITE_LEN   2   /* EVERY HDC1080 REGISTER IS 16 BITS */
+#define HDC1080_WORKER_COLLECT  0x01  /* WORKER NOTIFICATION, A CONVERSION IS READY TO READ */
+#define HDC1080_WORKER_EXIT     0x02  /* WORKER NOTIFICATION, THE HANDLE IS BEING DELETED */
+#define HDC1080_WORKER_SAMPLE   0x04  /* WORKER NOTIFICATION, A CONTINUOUS SAMPLING SLOT CAME UP */
+_Static_assert(HDC1080_NOTIFY_INDEX >= 0 && HDC1080_NOTIFY_INDEX < configTASK_NOTIFICATION_ARRAY_ENTRIES,
+               "HDC1080_NOTIFY_INDEX MUST BE BELOW CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES");
+
+/* A REQUEST WAITING ON THE IN FLIGHT CONVERSION, EITHER A ONE SHOT
+ * CALLBACK OR A TASK BLOCKED IN hdc1080_read_sync
+ * in_use -> THE SLOT IS TAKEN
+ * callback/user_ctx -> ONE SHOT CALLBACK, NULL FOR A BLOCKED TASK
+ * task -> THE TASK TO NOTIFY ONCE readings AND error ARE FILLED */
+typedef struct HDC1080_WAITER {
+  bool in_use;
+  hdc1080_sensor_callback callback;
+  void * user_ctx;
+  TaskHandle_t task;
+  hdc1080_sensor_readings_t * readings;
+  esp_err_t * error;
+} hdc1080_waiter_t;
+
+/* LOCK FREE COUNTERS BEHIND hdc1080_stats_t, ONLY EVER BUMPED WITH
+ * RELAXED ATOMICS SO THEY COST NEXT TO NOTHING ON THE HOT PATH */
+typedef struct HDC1080_COUNTERS {
+  atomic_uint conversions_started;
+  atomic_uint conversions_completed;
+  atomic_uint retries;
+  atomic_uint errors_nack;
+  atomic_uint errors_timeout;
+  atomic_uint errors_invalid_state;
+  atomic_uint errors_other;
+  atomic_uint converting;
+  atomic_uint sink_dropped;
+  atomic_uint decimated;
+  atomic_uint suppressed;
+  atomic_uint samples_dropped;
+  atomic_uint bus_transactions;
+  atomic_uint bus_time;
+  atomic_uint latency_max;
+  atomic_uint latency[HDC1080_LATENCY_BUCKETS];
+  atomic_uint missed_slots;
+  atomic_uint jitter_max;
+  atomic_uint fast_failed;
+  atomic_uint recoveries;
+  atomic_uint recoveries_failed;
+} hdc1080_counters_t;
+
+/* ONE PORT WORTH OF hdc1080_configure_all, EVERY SENSOR ON THE SAME PORT
+ * AS settings[leader] IS CONFIGURED IN ORDER BY ONE TASK
+ * done -> GIVEN ONCE THE PORT IS FINISHED WHEN RUN IN ITS OWN TASK */
+typedef struct HDC1080_PROBE_JOB {
+  hdc1080_settings_t * settings;
+  const hdc1080_config_t * cfgs;
+  hdc1080_handle_t * handles;
+  esp_err_t * results;
+  size_t count;
+  size_t leader;
+  SemaphoreHandle_t done;
+} hdc1080_probe_job_t;
+
+#define HDC1080_COUNT(HDC, COUNTER, AMOUNT) atomic_fetch_add_explicit(&(HDC)->counters.COUNTER, (AMOUNT), memory_order_relaxed)
+
+/* PER SENSOR INSTANCE STATE, EVERYTHING THE DRIVER NEEDS TO
+ * TALK TO ONE HDC1080 LIVES HERE SO ANY NUMBER OF SENSORS
+ * ON ANY NUMBER OF PORTS CAN BE DRIVEN AT THE SAME TIME
+ * settings -> COPY OF THE PORT AND CALLBACK SETTINGS
+ * config -> THE REGISTER CONFIGURATION WRITTEN TO THE DEVICE
+ * conversion_wait -> MICROSECONDS A REQUEST TAKES WITH THIS CONFIG AND CHANNEL
+ * conversion_started -> esp_timer TIME THE IN FLIGHT CONVERSION WAS REQUESTED
+ * conversion_jitter -> MICROSECONDS THE IN FLIGHT CONVERSION STARTED AFTER
+ *                      ITS SLOT, 0 WHEN IT WAS NOT A CONTINUOUS SAMPLE
+ * conversion_deadline -> esp_timer TIME AFTER WHICH POLLING GIVES UP
+ * conversion_ready -> esp_timer TIME THE IN FLIGHT CONVERSION CAN BE READ
+ * conversion_reg -> MEASUREMENT REGISTER THE IN FLIGHT CONVERSION WAS STARTED ON
+ * conversion_raw -> CODES READ SO FAR FOR THE IN FLIGHT REQUEST
+ * conversion_timer_h -> TIMER USED TO WAIT OUT THE CONVERSION
+ * sample_timer_h -> ONE SHOT TIMER RE-ARMED FOR EVERY CONTINUOUS SAMPLING SLOT
+ * sample_period -> MICROSECONDS BETWEEN CONTINUOUS SAMPLING SLOTS
+ * sample_slot -> esp_timer TIME OF THE NEXT SLOT, ALWAYS ON THE GRID
+ *                ANCHORED WHEN hdc1080_start_continuous WAS CALLED
+ * worker_h -> TASK THE CONVERSION AND SAMPLING TIMERS HAND THEIR WORK OFF TO,
+ *             CREATED BY hdc1080_configure WITH use_worker_task OR BY THE
+ *             FIRST hdc1080_start_continuous
+ * deleter -> TASK IN hdc1080_delete THE WORKER ACKNOWLEDGES HDC1080_WORKER_EXIT TO
+ * lock -> GUARDS THE BUS ACCESS AND THE CONVERSION STATE
+ * awaiting_conversion -> TRUE WHILE A CONVERSION IS IN FLIGHT
+ * delivering -> TRUE FROM THE END OF A CONVERSION UNTIL ITS READINGS ARE
+ *               DELIVERED, SET UNDER THE LOCK AND CLEARED AS THE LAST
+ *               ACCESS TO THE HANDLE SO hdc1080_delete CAN WAIT IT OUT
+ * manual -> TRUE WHILE THE IN FLIGHT CONVERSION WAS STARTED BY
+ *           hdc1080_start_measurement, THE CALLER READS IT BACK
+ * sink_requested -> TRUE WHEN THE IN FLIGHT CONVERSION GOES TO THE SINK
+ * waiters -> EXTRA REQUESTS ATTACHED TO THE IN FLIGHT CONVERSION
+ * continuous -> TRUE WHILE CONTINUOUS SAMPLING IS RUNNING
+ * samples -> SINGLE PRODUCER/SINGLE CONSUMER RING OF RAW SAMPLES, THE
+ *            CONVERSION TIMER IS THE ONLY PRODUCER AND THE TASK CALLING
+ *            hdc1080_drain_samples THE ONLY CONSUMER
+ * samples_mask -> RING LENGTH - 1, THE LENGTH IS ALWAYS A POWER OF 2
+ * samples_head -> FREE RUNNING WRITE COUNT, ONLY MOVED BY THE PRODUCER
+ * samples_tail -> FREE RUNNING READ COUNT, ONLY MOVED BY THE CONSUMER
+ * filter_state -> STATE OF settings.filter, ONLY TOUCHED UNDER THE LOCK
+ * serial_id -> THE 41 BIT SERIAL, VALID ONCE serial_known IS TRUE
+ * health_failures -> FAILED BUS OPERATIONS IN A ROW, health_failures,
+ *                    health_down AND health_retry_at ARE ONLY TOUCHED UNDER THE LOCK
+ * health_down -> failure_threshold WAS REACHED, THE SENSOR IS RECOVERED
+ *                BEFORE IT IS USED AGAIN
+ * health_retry_at -> esp_timer TIME UNTIL WHICH CALLS FAIL FAST
+ * counters -> RUNTIME STATISTICS, SEE hdc1080_get_stats
+ */
+struct hdc1080_dev_t {
+  hdc1080_settings_t settings;
+  hdc1080_config_t config;
+  unsigned int conversion_wait;
+  int64_t conversion_started;
+  int32_t conversion_jitter;
+  int64_t conversion_deadline;
+  int64_t conversion_ready;
+  unsigned char conversion_reg;
+  hdc1080_raw_readings_t conversion_raw;
+  esp_timer_handle_t conversion_timer_h;
+  esp_timer_handle_t sample_timer_h;
+  unsigned int sample_period;
+  int64_t sample_slot;
+  TaskHandle_t worker_h;
+  TaskHandle_t deleter;
+  SemaphoreHandle_t lock;
+  bool awaiting_conversion;
+  atomic_bool delivering;
+  bool manual;
+  bool sink_requested;
+  hdc1080_waiter_t waiters[HDC1080_MAX_WAITERS];
+  bool continuous;
+  hdc1080_sample_t * samples;
+  unsigned int samples_mask;
+  atomic_uint samples_head;
+  atomic_uint samples_tail;
+  hdc1080_filter_state_t filter_state;
+  uint64_t serial_id;
+  bool serial_known;
+  unsigned int health_failures;
+  bool health_down;
+  int64_t health_retry_at;
+  hdc1080_counters_t counters;
+};
+
+static esp_err_t read_hdc100_data(hdc1080_handle_t hdc, unsigned char i2c_register, unsigned char * read_buff, size_t read_len);
+static esp_err_t write_hdc100_data(hdc1080_handle_t hdc, unsigned char i2c_register, unsigned char * write_buff, size_t write_len);
+static esp_err_t hdc1080_i2c_transfer(hdc1080_handle_t hdc, const unsigned char * write_buff, size_t write_len, unsigned char * read_buff, size_t read_len);
+static esp_err_t hdc1080_i2c_driver_transfer(void * bus_ctx, unsigned char i2c_address, const unsigned char * write_buff, size_t write_len, unsigned char * read_buff, size_t read_len, TickType_t timeout);
+static esp_err_t check_hdc1080_error(hdc1080_handle_t hdc, esp_err_t hdc_err);
+static void hdc1080_record_latency(hdc1080_handle_t hdc);
 static void hdc1080_conversion_completed(void* arg);
-static hdc1080_settings_t hdc1080_set = {0};
-static esp_timer_handle_t hdc1080_conversion_timer_h;
-static bool awaiting_conversion = false;
+static void hdc1080_worker_task(void* arg);
+static void hdc1080_collect_readings(hdc1080_handle_t hdc);
+static esp_err_t hdc1080_read_conversion(hdc1080_handle_t hdc);
+static hdc1080_sensor_readings_t hdc1080_convert_readings(esp_err_t read_err, hdc1080_raw_readings_t raw, unsigned char channel);
+static void hdc1080_deliver_readings(hdc1080_handle_t hdc, esp_err_t read_err, const hdc1080_sample_t * sample, unsigned char channel);
+static void hdc1080_sample_period_elapsed(void* arg);
+static void hdc1080_sample_slot(hdc1080_handle_t hdc);
+static esp_err_t hdc1080_start_worker(hdc1080_handle_t hdc);
+static void hdc1080_timer_fence(void* arg);
+static esp_err_t hdc1080_start_conversion(hdc1080_handle_t hdc);
+static esp_err_t hdc1080_trigger_conversion(hdc1080_handle_t hdc, unsigned char trigger_reg);
+static esp_err_t hdc1080_attach_request(hdc1080_handle_t hdc, const hdc1080_waiter_t * waiter, int * slot);
+static void hdc1080_push_sample(hdc1080_handle_t hdc, const hdc1080_sample_t * sample);
+static esp_err_t hdc1080_verify_identity(hdc1080_handle_t hdc);
+static esp_err_t hdc1080_read_serial_id(hdc1080_handle_t hdc);
+static esp_err_t hdc1080_write_configuration(hdc1080_handle_t hdc, hdc1080_config_t hdc_cfg, bool check_first);
+static bool hdc1080_warm_start_valid(const hdc1080_settings_t * settings);
+static void hdc1080_store_warm_start(hdc1080_handle_t hdc);
+static uint32_t hdc1080_warm_start_checksum(const hdc1080_warm_start_t * warm_start);
+static bool hdc1080_same_port(const hdc1080_settings_t * a, const hdc1080_settings_t * b);
+static void hdc1080_probe_port(hdc1080_probe_job_t * job);
+static void hdc1080_probe_task(void * arg);
+static esp_err_t hdc1080_health_gate(hdc1080_handle_t hdc, bool recover);
+static void hdc1080_health_record(hdc1080_handle_t hdc, esp_err_t bus_err);
+static int64_t hdc1080_health_backoff(hdc1080_handle_t hdc);
+static esp_err_t hdc1080_recover_device(hdc1080_handle_t hdc);
+static esp_err_t hdc1080_i2c_driver_clear(void * bus_ctx);
+static bool hdc1080_lock(hdc1080_handle_t hdc);
+static void hdc1080_unlock(hdc1080_handle_t hdc);
 
 /* -------------------------------------------------------------
  * @name void hdc1080_conversion_completed(void* arg)
  * -------------------------------------------------------------
- * @brief callback from the conversion timer. Gets the current
- * sensor readings and callsback to the original request set
- * during configuration
+ * @brief callback from the conversion timer. Collects the
+ * readings right here in the esp_timer task, or when the
+ * instance has a worker task just wakes the worker up
+ * @param arg -> the hdc1080_handle_t that started the conversion
+ * @note The esp_timer task is shared with every other timer so it
+ *       never waits on the lock, a busy lock pushes the collect back
+ *       by HDC1080_POLL_INTERVAL. hdc1080_delete cannot free the
+ *       handle meanwhile since the conversion is still in flight
  */
 static void hdc1080_conversion_completed(void* arg){
-  hdc1080_sensor_readings_t sens_readings = {0};
+  hdc1080_handle_t hdc = (hdc1080_handle_t)arg;
+  if(hdc->worker_h != NULL){
+    xTaskNotify(hdc->worker_h, HDC1080_WORKER_COLLECT, eSetBits);
+    return;
+  }
+  if(xSemaphoreTake(hdc->lock, 0) != pdTRUE){
+    if(esp_timer_start_once(hdc->conversion_timer_h, HDC1080_POLL_INTERVAL) == ESP_OK){ return; }
+    // WITHOUT THE RETRY THE CONVERSION WOULD NEVER FINISH, WAITING IS THE LESSER EVIL
+    xSemaphoreTake(hdc->lock, portMAX_DELAY);
+  }
+  hdc1080_collect_readings(hdc);
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_worker_task(void* arg)
+ * -------------------------------------------------------------
+ * @brief Driver owned task that starts the continuous sampling
+ * conversions, does the i2c read and delivers the readings so the
+ * esp_timer task never blocks on the lock or the bus
+ * @param arg -> the hdc1080_handle_t this worker serves
+ * @note HDC1080_WORKER_EXIT is acknowledged to the deleting task
+ *       and the handle is not touched after that since
+ *       hdc1080_delete frees it as soon as the acknowledgement comes
+ */
+static void hdc1080_worker_task(void* arg){
+  hdc1080_handle_t hdc = (hdc1080_handle_t)arg;
+  uint32_t work = 0;
+  while(true){
+    xTaskNotifyWait(0, UINT32_MAX, &work, portMAX_DELAY);
+    if(work & HDC1080_WORKER_EXIT){ break; }
+    if(work & HDC1080_WORKER_COLLECT){
+      xSemaphoreTake(hdc->lock, portMAX_DELAY);
+      hdc1080_collect_readings(hdc);
+    }
+    if(work & HDC1080_WORKER_SAMPLE){ hdc1080_sample_slot(hdc); }
+  }
+  TaskHandle_t deleter = hdc->deleter;
+  xTaskNotifyGiveIndexed(deleter, HDC1080_NOTIFY_INDEX);
+  vTaskDelete(NULL);
+}
+
+/* -------------------------------------------------------------
+ * @name static esp_err_t hdc1080_start_worker(hdc1080_handle_t hdc)
+ * -------------------------------------------------------------
+ * @brief Create the worker task of an instance
+ * @param hdc -> the instance, without a worker yet
+ * @return ESP_OK on success, ESP_ERR_NO_MEM when the task could
+ *         not be created
+ */
+static esp_err_t hdc1080_start_worker(hdc1080_handle_t hdc){
+  UBaseType_t priority = hdc->settings.worker_priority;
+  if(priority == 0){ priority = HDC1080_WORKER_PRIORITY; }
+  if(xTaskCreate(hdc1080_worker_task, "hdc1080_worker", HDC1080_WORKER_STACK_SIZE, hdc, priority, &hdc->worker_h) != pdPASS){
+    hdc->worker_h = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_collect_readings(hdc1080_handle_t hdc)
+ * -------------------------------------------------------------
+ * @brief Read the finished conversion, mark the instance idle
+ * and hand the readings to wherever they are configured to go
+ * @param hdc -> the instance that started the conversion, its lock
+ *        must be held and is given back before the delivery
+ */
+static void hdc1080_collect_readings(hdc1080_handle_t hdc){
+  hdc1080_raw_readings_t raw = {0};
+  unsigned char channel = hdc->settings.channel;
+  if(hdc->config.mode_of_acquisition == HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE){ channel = HDC1080_CHANNEL_BOTH; }
+  // READ IN THE DATA UNDER THE LOCK, REQUESTS MAY ATTACH TO THE CONVERSION AND
+  // hdc1080_get_health READS THE HEALTH STATE THE READ UPDATES WHILE IT IS IN FLIGHT
+  esp_err_t err_ck = hdc1080_read_conversion(hdc);
+  if(err_ck == HDC1080_CONVERTING){
+    hdc1080_unlock(hdc);
+    return;
+  }
+  hdc1080_record_latency(hdc);
+  if(err_ck == ESP_OK){
+    HDC1080_COUNT(hdc, conversions_completed, 1);
+    raw = hdc->conversion_raw;
+  }
+  // ATTACHED REQUESTS GET THE CONVERSION AS READ, NOT THE FILTERED ONE
+  hdc1080_sensor_readings_t sens_readings = hdc1080_convert_readings(err_ck, raw, channel);
+  // MARK THE FINISHED STATE, THIS MUST NOT BE SKIPPED OR THE HANDLE STAYS BUSY
+  // TASKS BLOCKED IN hdc1080_read_sync ARE ANSWERED UNDER THE LOCK SO ONE THAT
+  // TIMED OUT KNOWS ITS READINGS AND NOTIFICATION ARE ALREADY THERE OR NEVER COME
+  hdc1080_waiter_t waiters[HDC1080_MAX_WAITERS];
+  bool continuous = hdc->continuous;
+  bool sink_requested = hdc->sink_requested;
+  for(int i = 0; i < HDC1080_MAX_WAITERS; i++){
+    waiters[i] = hdc->waiters[i];
+    if(waiters[i].in_use && waiters[i].callback == NULL){
+      *waiters[i].readings = sens_readings;
+      *waiters[i].error = err_ck;
+      xTaskNotifyGiveIndexed(waiters[i].task, HDC1080_NOTIFY_INDEX);
+      waiters[i].in_use = false;
+    }
+  }
+  memset(hdc->waiters, 0, sizeof(hdc->waiters));
+  hdc->sink_requested = false;
+  hdc->awaiting_conversion = false;
+  atomic_store_explicit(&hdc->delivering, true, memory_order_relaxed);
+  // TAKEN UNDER THE LOCK, THE NEXT SLOT MAY START A CONVERSION AS SOON AS IT IS GIVEN BACK
+  hdc1080_sample_t sample = {
+    .timestamp = hdc->conversion_started,
+    .raw = raw,
+    .jitter = hdc->conversion_jitter
+  };
+  // ONLY THE SINK AND THE RING ARE FILTERED, FAILED READS ALWAYS GO THROUGH
+  unsigned char filter_result = HDC1080_FILTER_PASS;
+  if(err_ck == ESP_OK && (continuous || sink_requested)){
+    filter_result = hdc1080_filter_push(&hdc->settings.filter, &hdc->filter_state, channel, &sample.raw, sample.timestamp);
+  }
+  hdc1080_unlock(hdc);
+  if(filter_result == HDC1080_FILTER_DECIMATED){ HDC1080_COUNT(hdc, decimated, 1); }
+  if(filter_result == HDC1080_FILTER_SUPPRESSED){ HDC1080_COUNT(hdc, suppressed, 1); }
+  if(filter_result != HDC1080_FILTER_PASS){ sink_requested = false; }
+  if(continuous && hdc->samples != NULL){
+    // WITH A RING CONTINUOUS SAMPLES ONLY GO THERE, FAILED READS ARE SKIPPED
+    if(err_ck == ESP_OK && filter_result == HDC1080_FILTER_PASS){ hdc1080_push_sample(hdc, &sample); }
+  }else if((continuous && filter_result == HDC1080_FILTER_PASS) || sink_requested){
+    // WITHOUT A RING CONTINUOUS SAMPLES GO TO THE SINK
+    hdc1080_deliver_readings(hdc, err_ck, &sample, channel);
+  }
+  // EVERY ONE SHOT CALLBACK THAT WAS TAKEN OUT GETS THE SAME READINGS, WHATEVER MODE THE HANDLE IS IN NOW
+  for(int i = 0; i < HDC1080_MAX_WAITERS; i++){
+    if(waiters[i].in_use){ waiters[i].callback(sens_readings, waiters[i].user_ctx); }
+  }
+  // LAST ACCESS TO THE HANDLE, hdc1080_delete MAY FREE IT RIGHT AFTER
+  atomic_store_explicit(&hdc->delivering, false, memory_order_release);
+}
+
+/* -------------------------------------------------------------
+ * @name static esp_err_t hdc1080_read_conversion(hdc1080_handle_t hdc)
+ * -------------------------------------------------------------
+ * @brief Read the in flight conversion into conversion_raw
+ * @param hdc -> the instance that started the conversion
+ * @return ESP_OK once every channel of the request is read,
+ *         HDC1080_CONVERTING when the HDC1080 is still converting
+ *         or the next conversion of the request was started, the
+ *         conversion timer is then re-armed and conversion_ready
+ *         holds when to read again, otherwise the read error
+ */
+static esp_err_t hdc1080_read_conversion(hdc1080_handle_t hdc){
   unsigned char read_buff[4];
-  // READ IN THE DATA
-  esp_err_t err_ck = check_hdc1080_error(i2c_master_read_from_device(hdc1080_set.i2c_port_number, hdc1080_set.i2c_address, (unsigned char *)read_buff, sizeof(read_buff), hdc1080_set.timeout_length));
+  // BOTH MEASUREMENTS COME BACK IN ONE 4 BYTE READ IN HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE
+  // MODE, OTHERWISE ONLY THE 2 BYTES OF THE REGISTER THE CONVERSION WAS STARTED ON
+  bool combined = (hdc->config.mode_of_acquisition == HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE);
+  esp_err_t err_ck = hdc1080_i2c_transfer(hdc, NULL, 0, read_buff, combined ? 4 : 2);
+  if(err_ck == ESP_FAIL && hdc->settings.completion_mode == HDC1080_COMPLETION_POLL && esp_timer_get_time() < hdc->conversion_deadline){
+    // THE HDC1080 NACKS ITS ADDRESS UNTIL THE CONVERSION IS DONE, TRY AGAIN SHORTLY
+    hdc->conversion_ready = esp_timer_get_time() + HDC1080_POLL_INTERVAL;
+    if(hdc->manual || esp_timer_start_once(hdc->conversion_timer_h, HDC1080_POLL_INTERVAL) == ESP_OK){
+      HDC1080_COUNT(hdc, retries, 1);
+      return HDC1080_CONVERTING;
+    }
+  }
+  if(check_hdc1080_error(hdc, err_ck) != ESP_OK){ return err_ck; }
+  if(combined){
+    hdc->conversion_raw.temperature = (unsigned short)((read_buff[0] << 8) | read_buff[1]);
+    hdc->conversion_raw.humidity = (unsigned short)((read_buff[2] << 8) | read_buff[3]);
+  }else if(hdc->conversion_reg == HDC1080_TEMPERATURE_REG){
+    hdc->conversion_raw.temperature = (unsigned short)((read_buff[0] << 8) | read_buff[1]);
+    // BOTH CHANNELS IN SEPARATE MODE, FOLLOW UP WITH THE HUMIDITY CONVERSION
+    if(hdc->settings.channel == HDC1080_CHANNEL_BOTH){
+      err_ck = hdc1080_trigger_conversion(hdc, HDC1080_HUMIDITY_REG);
+      return (err_ck == ESP_OK) ? HDC1080_CONVERTING : err_ck;
+    }
+  }else{
+    hdc->conversion_raw.humidity = (unsigned short)((read_buff[0] << 8) | read_buff[1]);
+  }
+  return ESP_OK;
+}
+
+/* -------------------------------------------------------------
+ * @name static hdc1080_sensor_readings_t hdc1080_convert_readings(esp_err_t read_err, hdc1080_raw_readings_t raw, unsigned char channel)
+ * -------------------------------------------------------------
+ * @brief Turn the raw codes into float readings
+ * @param read_err -> result of the i2c read
+ * @param raw -> the raw codes
+ * @param channel -> the HDC1080_CHANNEL_* that was measured
+ * @return the readings, 0 for both when the read failed and NAN
+ *         for a channel that was not measured
+ */
+static hdc1080_sensor_readings_t hdc1080_convert_readings(esp_err_t read_err, hdc1080_raw_readings_t raw, unsigned char channel){
+  hdc1080_sensor_readings_t sens_readings = {0};
+  // IF NO ERROR OCCURED THEN DO THE FLOAT CONVERSION 
+  // OTHERWISE 0 WILL BE RETURNED FOR BOTH VALUES TO SIGNAL AND ISSUE
+  if(read_err != ESP_OK){ return sens_readings; }
+  hdc1080_raw_to_float(&raw, &sens_readings, 1);
+  if(channel == HDC1080_CHANNEL_TEMPERATURE){ sens_readings.humidity = NAN; }
+  if(channel == HDC1080_CHANNEL_HUMIDITY){ sens_readings.temperature = NAN; }
+  return sens_readings;
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_deliver_readings(hdc1080_handle_t hdc, esp_err_t read_err, const hdc1080_sample_t * sample, unsigned char channel)
+ * -------------------------------------------------------------
+ * @brief Send the readings to the configured sink
+ * @param hdc -> the instance the readings came from
+ * @param read_err -> result of the i2c read
+ * @param sample -> the raw codes, 0 for both when the read failed,
+ *        with the conversion start time and jitter
+ * @param channel -> the HDC1080_CHANNEL_* that was measured
+ */
+static void hdc1080_deliver_readings(hdc1080_handle_t hdc, esp_err_t read_err, const hdc1080_sample_t * sample, unsigned char channel){
+  if(hdc->settings.sink == HDC1080_SINK_CALLBACK && hdc->settings.raw_callback != NULL){
+    // RAW CODES ARE HANDED OVER AS READ, 0 FOR BOTH SIGNALS AN ISSUE
+    hdc->settings.raw_callback(sample->raw, hdc->settings.user_ctx);
+    return;
+  }
+  hdc1080_sensor_readings_t sens_readings = hdc1080_convert_readings(read_err, sample->raw, channel);
+  hdc1080_readings_event_t readings_event = {
+    .handle = hdc,
+    .user_ctx = hdc->settings.user_ctx,
+    .error = read_err,
+    .raw = sample->raw,
+    .readings = sens_readings,
+    .timestamp = sample->timestamp,
+    .jitter = sample->jitter
+  };
+  switch(hdc->settings.sink){
+    case HDC1080_SINK_QUEUE:
+      // NEVER BLOCK THE DRIVER ON A FULL QUEUE, THE READING IS DROPPED INSTEAD
+      if(xQueueSend(hdc->settings.readings_queue, &readings_event, 0) != pdTRUE){
+        HDC1080_COUNT(hdc, sink_dropped, 1);
+        ESP_LOGW("HDC1080", "READINGS QUEUE FULL, READING DROPPED");
+      }
+    break;
+    case HDC1080_SINK_EVENT:
+      if(hdc->settings.event_loop != NULL){
+        read_err = esp_event_post_to(hdc->settings.event_loop, HDC1080_EVENT, HDC1080_EVENT_READINGS, &readings_event, sizeof(readings_event), 0);
+      }else{
+        read_err = esp_event_post(HDC1080_EVENT, HDC1080_EVENT_READINGS, &readings_event, sizeof(readings_event), 0);
+      }
+      // A FULL EVENT QUEUE LOSES THE READING LIKE A FULL READINGS QUEUE, IT SAYS NOTHING ABOUT THE BUS
+      if(read_err != ESP_OK){
+        HDC1080_COUNT(hdc, sink_dropped, 1);
+        ESP_LOGW("HDC1080", "READINGS EVENT NOT POSTED: %s", esp_err_to_name(read_err));
+      }
+    break;
+    default:
+      if(hdc->settings.callback != NULL){
+        hdc->settings.callback(sens_readings, hdc->settings.user_ctx);  // RUN THE CONFIGURED CALLBACK
+      }
+    break;
+  }
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_push_sample(hdc1080_handle_t hdc, const hdc1080_sample_t * sample)
+ * -------------------------------------------------------------
+ * @brief Store a raw sample in the ring, producer side
+ * @param hdc -> the instance that took the sample
+ * @param sample -> the codes read from the HDC1080 and when the
+ *        conversion was started
+ * @note Only ever called from the conversion timer so there is
+ *       a single producer, a full ring drops the new sample
+ */
+static void hdc1080_push_sample(hdc1080_handle_t hdc, const hdc1080_sample_t * sample){
+  unsigned int head = atomic_load_explicit(&hdc->samples_head, memory_order_relaxed);
+  unsigned int tail = atomic_load_explicit(&hdc->samples_tail, memory_order_acquire);
+  if((head - tail) > hdc->samples_mask){
+    HDC1080_COUNT(hdc, samples_dropped, 1);
+    return;
+  }
+  hdc->samples[head & hdc->samples_mask] = *sample;
+  // PUBLISH THE SLOT ONLY AFTER IT IS WRITTEN
+  atomic_store_explicit(&hdc->samples_head, head + 1, memory_order_release);
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_record_latency(hdc1080_handle_t hdc)
+ * -------------------------------------------------------------
+ * @brief Add the request to result time of the conversion that
+ * just finished to the latency histogram
+ * @param hdc -> the instance the conversion ran on
+ */
+static void hdc1080_record_latency(hdc1080_handle_t hdc){
+  unsigned int latency = (unsigned int)(esp_timer_get_time() - hdc->conversion_started);
+  unsigned int bucket = 0;
+  while(bucket < (HDC1080_LATENCY_BUCKETS - 1) && latency >= ((unsigned int)HDC1080_LATENCY_BUCKET_BASE << bucket)){ bucket++; }
+  HDC1080_COUNT(hdc, latency[bucket], 1);
+  // ONLY RAISE THE MAXIMUM, A RACING RESET JUST STARTS IT OVER
+  unsigned int latency_max = atomic_load_explicit(&hdc->counters.latency_max, memory_order_relaxed);
+  while(latency > latency_max && !atomic_compare_exchange_weak_explicit(&hdc->counters.latency_max, &latency_max, latency, memory_order_relaxed, memory_order_relaxed));
+}
+
+/* -------------------------------------------------------------
+ * @name size_t hdc1080_drain_samples(hdc1080_handle_t hdc_handle, hdc1080_sample_t * samples, size_t max_samples)
+ * -------------------------------------------------------------
+ * @brief Pull up to max_samples out of the ring in one go, oldest first
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param samples -> array to copy the samples into
+ * @param max_samples -> length of the samples array
+ * @return the number of samples copied
+ * @note Lock free, only one task may drain a given handle
+ */
+size_t hdc1080_drain_samples(hdc1080_handle_t hdc_handle, hdc1080_sample_t * samples, size_t max_samples){
+  if(hdc_handle == NULL || samples == NULL || hdc_handle->samples == NULL){ return 0; }
+  unsigned int tail = atomic_load_explicit(&hdc_handle->samples_tail, memory_order_relaxed);
+  unsigned int head = atomic_load_explicit(&hdc_handle->samples_head, memory_order_acquire);
+  size_t count = head - tail;
+  if(count > max_samples){ count = max_samples; }
+  // COPY IN AT MOST TWO RUNS, UP TO THE END OF THE RING AND THEN FROM THE START
+  unsigned int first = tail & hdc_handle->samples_mask;
+  size_t run = (hdc_handle->samples_mask + 1) - first;
+  if(run > count){ run = count; }
+  memcpy(samples, &hdc_handle->samples[first], run * sizeof(hdc1080_sample_t));
+  memcpy(&samples[run], hdc_handle->samples, (count - run) * sizeof(hdc1080_sample_t));
+  // HAND THE SLOTS BACK TO THE PRODUCER ONLY AFTER THEY ARE COPIED
+  atomic_store_explicit(&hdc_handle->samples_tail, tail + count, memory_order_release);
+  return count;
+}
+
+/* -------------------------------------------------------------
+ * @name void hdc1080_raw_to_fixed(const hdc1080_raw_readings_t * raw, hdc1080_fixed_readings_t * fixed, size_t count)
+ * -------------------------------------------------------------
+ * @brief Convert an array of raw readings to centi-degrees and
+ * centi-percent using integer math only
+ * @param raw -> the raw readings to convert
+ * @param fixed -> array of at least count entries to fill
+ * @param count -> number of readings to convert
+ */
+void hdc1080_raw_to_fixed(const hdc1080_raw_readings_t * raw, hdc1080_fixed_readings_t * fixed, size_t count){
+  for(size_t i = 0; i < count; i++){
+    fixed[i].temperature = hdc1080_temperature_centi(raw[i].temperature);
+    fixed[i].humidity = hdc1080_humidity_centi(raw[i].humidity);
+  }
+}
+
+/* -------------------------------------------------------------
+ * @name void hdc1080_raw_to_float(const hdc1080_raw_readings_t * raw, hdc1080_sensor_readings_t * readings, size_t count)
+ * -------------------------------------------------------------
+ * @brief Convert an array of raw readings to degrees celsius and
+ * percent relative humidity, the float path the sinks deliver
+ * @param raw -> the raw readings to convert
+ * @param readings -> array of at least count entries to fill
+ * @param count -> number of readings to convert
+ */
+void hdc1080_raw_to_float(const hdc1080_raw_readings_t * raw, hdc1080_sensor_readings_t * readings, size_t count){
+  for(size_t i = 0; i < count; i++){
+    readings[i].temperature = ((((float)raw[i].temperature/65536) * 165) - 40);   /* pow(2, 16) ==  65536 */
+    readings[i].humidity = (((float)raw[i].humidity/65536) * 100);
+  }
+}
+
+/* -------------------------------------------------------------
+ * @name void hdc1080_samples_to_fixed(const hdc1080_sample_t * samples, hdc1080_fixed_readings_t * fixed, size_t count)
+ * -------------------------------------------------------------
+ * @brief Same as hdc1080_raw_to_fixed for samples drained from
+ * the continuous sampling ring
+ * @param samples -> the samples to convert
+ * @param fixed -> array of at least count entries to fill
+ * @param count -> number of samples to convert
+ */
+void hdc1080_samples_to_fixed(const hdc1080_sample_t * samples, hdc1080_fixed_readings_t * fixed, size_t count){
+  for(size_t i = 0; i < count; i++){
+    fixed[i].temperature = hdc1080_temperature_centi(samples[i].raw.temperature);
+    fixed[i].humidity = hdc1080_humidity_centi(samples[i].raw.humidity);
+  }
+}
+
+/* -------------------------------------------------------------
+ * @name size_t hdc1080_stream_encode_samples(hdc1080_stream_encoder_t * encoder, const hdc1080_sample_t * samples, size_t count)
+ * -------------------------------------------------------------
+ * @brief Same as hdc1080_stream_encode for samples drained from
+ * the continuous sampling ring
+ * @param encoder -> the encoder, see hdc1080_stream.h
+ * @param samples -> the samples, oldest first
+ * @param count -> number of samples
+ * @return the number of samples added, less than count when the
+ *         encoder buffer filled up
+ */
+size_t hdc1080_stream_encode_samples(hdc1080_stream_encoder_t * encoder, const hdc1080_sample_t * samples, size_t count){
+  size_t added = 0;
+  for(; added < count; added++){
+    hdc1080_stream_sample_t sample = {
+      .timestamp = samples[added].timestamp,
+      .temperature = samples[added].raw.temperature,
+      .humidity = samples[added].raw.humidity
+    };
+    if(!hdc1080_stream_put(encoder, &sample)){ break; }
+  }
+  return added;
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_sample_period_elapsed(void* arg)
+ * -------------------------------------------------------------
+ * @brief callback from the continuous sampling timer, just wakes
+ * the worker task up. hdc1080_start_continuous always starts one
+ * since a slot has to wait for the lock, the bus and possibly a
+ * recovery
+ * @param arg -> the hdc1080_handle_t being sampled
+ */
+static void hdc1080_sample_period_elapsed(void* arg){
+  hdc1080_handle_t hdc = (hdc1080_handle_t)arg;
+  xTaskNotify(hdc->worker_h, HDC1080_WORKER_SAMPLE, eSetBits);
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_sample_slot(hdc1080_handle_t hdc)
+ * -------------------------------------------------------------
+ * @brief Start the conversion of the slot that came up unless
+ * the last one is still in flight and arm the timer for the next
+ * slot on the grid. Slots are absolute times so the period never
+ * drifts by the time the timer dispatch, the bus or the callbacks take.
+ * Every slot either starts a conversion or is counted in missed_slots
+ * @param hdc -> the instance being sampled
+ */
+static void hdc1080_sample_slot(hdc1080_handle_t hdc){
+  // RUNS IN THE WORKER, NEVER GIVE UP ON THE LOCK HERE, A SKIPPED RE-ARM WOULD STOP SAMPLING
+  xSemaphoreTake(hdc->lock, portMAX_DELAY);
+  int64_t slot = hdc->sample_slot;
+  int64_t now = esp_timer_get_time();
+  // A WAKE UP LEFT OVER FROM BEFORE A STOP AND RESTART COMES AHEAD OF THE
+  // SLOT, THE TIMER IS ALREADY ARMED FOR IT
+  if(!hdc->continuous || now < slot){
+    hdc1080_unlock(hdc);
+    return;
+  }
+  // SLOTS THAT WENT BY WHILE THE LOCK WAS BUSY ARE SKIPPED, THE CONVERSION GOES TO THE LATEST ONE
+  if(now - slot >= hdc->sample_period){
+    int64_t skipped = (now - slot) / hdc->sample_period;
+    HDC1080_COUNT(hdc, missed_slots, (unsigned int)skipped);
+    slot += skipped * hdc->sample_period;
+  }
+  if(hdc->awaiting_conversion || hdc1080_health_gate(hdc, true) != ESP_OK || hdc1080_start_conversion(hdc) != ESP_OK){
+    HDC1080_COUNT(hdc, missed_slots, 1);
+  }else{
+    // HOW LATE THE CONVERSION STARTED AGAINST ITS SLOT, GOES OUT WITH THE SAMPLE
+    unsigned int jitter = (unsigned int)(hdc->conversion_started - slot);
+    hdc->conversion_jitter = (int32_t)jitter;
+    unsigned int jitter_max = atomic_load_explicit(&hdc->counters.jitter_max, memory_order_relaxed);
+    while(jitter > jitter_max && !atomic_compare_exchange_weak_explicit(&hdc->counters.jitter_max, &jitter_max, jitter, memory_order_relaxed, memory_order_relaxed));
+  }
+  // STAY ON THE GRID, SLOTS THAT ALREADY WENT BY ARE SKIPPED AND COUNTED
+  now = esp_timer_get_time();
+  slot += hdc->sample_period;
+  if(slot <= now){
+    int64_t missed = ((now - slot) / hdc->sample_period) + 1;
+    HDC1080_COUNT(hdc, missed_slots, (unsigned int)missed);
+    slot += missed * hdc->sample_period;
+  }
+  hdc->sample_slot = slot;
+  esp_timer_start_once(hdc->sample_timer_h, (uint64_t)(slot - now));
+  hdc1080_unlock(hdc);
+}
+
+/* -------------------------------------------------------------
+ * @name esp_err_t hdc1080_start_continuous(hdc1080_handle_t hdc_handle, unsigned int period)
+ * -------------------------------------------------------------
+ * @brief Start a conversion every period microseconds on a fixed
+ * grid anchored at this call, the first one a period from now.
+ * With a sample_buffer_length the samples are stored in the ring
+ * and read back with hdc1080_drain_samples, otherwise they go to
+ * the configured sink. Every sample is timestamped at its
+ * conversion start and carries how late that was against its slot.
+ * A slot that comes up while the last conversion is still in flight
+ * is skipped and counted in missed_slots. The slots run in the worker
+ * task, which is created here if use_worker_task did not already
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param period -> microseconds between conversion starts
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG when the period is
+ *         not longer than the conversion time, HDC1080_CONVERTING while
+ *         a request or a manual measurement is in flight,
+ *         ESP_ERR_INVALID_STATE if it already runs, ESP_ERR_NO_MEM
+ *         when the worker task could not be created
+ */
+esp_err_t hdc1080_start_continuous(hdc1080_handle_t hdc_handle, unsigned int period){
+  if(hdc_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  esp_err_t err_ck = ESP_OK;
+  if(hdc_handle->awaiting_conversion){
+    // A ONE SHOT OR MANUAL CONVERSION HAS TO FINISH FIRST, ITS REQUESTS ARE STILL WAITING ON IT
+    HDC1080_COUNT(hdc_handle, converting, 1);
+    err_ck = HDC1080_CONVERTING;
+  }else if(hdc_handle->continuous){
+    err_ck = ESP_ERR_INVALID_STATE;
+  }else if(period <= hdc_handle->conversion_wait){
+    // THE PERIOD HAS TO LEAVE ROOM FOR THE CONVERSION TO FINISH
+    err_ck = ESP_ERR_INVALID_ARG;
+  }else if(hdc_handle->worker_h == NULL){
+    // THE SLOTS NEVER RUN IN THE esp_timer TASK, THE WORKER STAYS UNTIL hdc1080_delete
+    err_ck = hdc1080_start_worker(hdc_handle);
+  }
+  if(err_ck == ESP_OK && hdc_handle->sample_timer_h == NULL){
+    const esp_timer_create_args_t hdc1080_sample_timer_args = {
+      .callback = &hdc1080_sample_period_elapsed,
+      .arg = hdc_handle,
+      .name = "hdc1080_sample_timer"
+    };
+    err_ck = esp_timer_create(&hdc1080_sample_timer_args, &hdc_handle->sample_timer_h);
+  }
   if(err_ck == ESP_OK){
-    // IF NO ERROR OCCURED THEN DO THE FLOAT CONVERSION 
-    // OTHERWISE 0 WILL BE RETURNED FOR BOTH VALUES TO SIGNAL AND ISSUE
-    sens_readings.temperature = ((((float)((read_buff[0] << 8) | read_buff[1])/65536) * 165) - 40);   /* pow(2, 16) ==  65536 */
-    sens_readings.humidity = (((float)((read_buff[2] << 8) | read_buff[3])/65536) * 100);
+    hdc_handle->continuous = true;
+    hdc_handle->sample_period = period;
+    hdc_handle->sample_slot = esp_timer_get_time() + period;
+    err_ck = esp_timer_start_once(hdc_handle->sample_timer_h, period);
+    if(err_ck != ESP_OK){ hdc_handle->continuous = false; }
+  }
+  hdc1080_unlock(hdc_handle);
+  return err_ck;
+}
+
+/* -------------------------------------------------------------
+ * @name esp_err_t hdc1080_stop_continuous(hdc1080_handle_t hdc_handle)
+ * -------------------------------------------------------------
+ * @brief Stop continuous sampling, samples already in the
+ * ring stay there until drained
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @return ESP_OK on success
+ */
+esp_err_t hdc1080_stop_continuous(hdc1080_handle_t hdc_handle){
+  if(hdc_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  if(!hdc_handle->continuous){
+    hdc1080_unlock(hdc_handle);
+    return ESP_ERR_INVALID_STATE;
   }
-  awaiting_conversion = false;  // MARK THE FINISHED STATE
-  hdc1080_set.callback(sens_readings);  // RUN THE CONFIGURED CALLBACK
+  esp_timer_stop(hdc_handle->sample_timer_h);
+  hdc_handle->continuous = false;
+  hdc1080_unlock(hdc_handle);
+  return ESP_OK;
 }
 
 /* -------------------------------------------------------------
- * @name esp_err_t hdc1080_request_readings(void)
+ * @name esp_err_t hdc1080_request_readings(hdc1080_handle_t hdc_handle)
  * -------------------------------------------------------------
  * @brief begin the read request for sensor data.
  * Sets the register to kickoff the conversion and starts a timer.
- * When the conversion timer completes it calls back to
- * hdc1080_conversion_completed
+ * When the conversion timer completes the readings go to the
+ * configured sink. A request made while a conversion is already
+ * in flight attaches to it and the sink receives those readings once
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @returns ESP_OK on success
+ */
+esp_err_t hdc1080_request_readings(hdc1080_handle_t hdc_handle){
+  if(hdc_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  esp_err_t err_ck = hdc1080_attach_request(hdc_handle, NULL, NULL);
+  if(err_ck == ESP_OK){ hdc_handle->sink_requested = true; }
+  hdc1080_unlock(hdc_handle);
+  return err_ck;
+}
+
+/* -------------------------------------------------------------
+ * @name esp_err_t hdc1080_request_readings_cb(hdc1080_handle_t hdc_handle, hdc1080_sensor_callback callback, void * user_ctx)
+ * -------------------------------------------------------------
+ * @brief Same as hdc1080_request_readings but the readings go to
+ * a one shot callback instead of the configured sink. Any number
+ * of callers, up to HDC1080_MAX_WAITERS, can attach to the same
+ * conversion and all of them receive the same readings
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param callback -> called once with the readings
+ * @param user_ctx -> passed back to the callback
+ * @returns ESP_OK on success, ESP_ERR_NO_MEM when every waiter
+ *          slot is taken
+ */
+esp_err_t hdc1080_request_readings_cb(hdc1080_handle_t hdc_handle, hdc1080_sensor_callback callback, void * user_ctx){
+  if(hdc_handle == NULL || callback == NULL){ return ESP_ERR_INVALID_ARG; }
+  hdc1080_waiter_t waiter = {
+    .in_use = true,
+    .callback = callback,
+    .user_ctx = user_ctx
+  };
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  esp_err_t err_ck = hdc1080_attach_request(hdc_handle, &waiter, NULL);
+  hdc1080_unlock(hdc_handle);
+  return err_ck;
+}
+
+/* -------------------------------------------------------------
+ * @name esp_err_t hdc1080_read_sync(hdc1080_handle_t hdc_handle, hdc1080_sensor_readings_t * sens_readings, TickType_t timeout)
+ * -------------------------------------------------------------
+ * @brief Request readings and block until they arrive, joining
+ * the in flight conversion when there is one. The calling task
+ * sleeps on its HDC1080_NOTIFY_INDEX task notification, anything
+ * pending on that index is cleared
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param sens_readings -> filled with the readings
+ * @param timeout -> ticks to wait for the readings
+ * @returns ESP_OK on success, ESP_ERR_TIMEOUT when the readings
+ *          did not arrive in time, otherwise the read error
+ * @note Must not be called from the sensor callbacks
+ */
+esp_err_t hdc1080_read_sync(hdc1080_handle_t hdc_handle, hdc1080_sensor_readings_t * sens_readings, TickType_t timeout){
+  if(hdc_handle == NULL || sens_readings == NULL){ return ESP_ERR_INVALID_ARG; }
+  esp_err_t read_err = ESP_OK;
+  int slot = -1;
+  hdc1080_waiter_t waiter = {
+    .in_use = true,
+    .task = xTaskGetCurrentTaskHandle(),
+    .readings = sens_readings,
+    .error = &read_err
+  };
+  // CLEAR ANY STALE GIVE BEFORE ATTACHING
+  ulTaskNotifyValueClearIndexed(NULL, HDC1080_NOTIFY_INDEX, UINT32_MAX);
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  esp_err_t err_ck = hdc1080_attach_request(hdc_handle, &waiter, &slot);
+  hdc1080_unlock(hdc_handle);
+  if(err_ck != ESP_OK){ return err_ck; }
+  if(ulTaskNotifyTakeIndexed(HDC1080_NOTIFY_INDEX, pdTRUE, timeout) > 0){ return read_err; }
+  // TIMED OUT, IF THE SLOT IS STILL OURS DETACH, OTHERWISE THE COMPLETION
+  // ALREADY ANSWERED IT UNDER THE LOCK AND THE NOTIFICATION IS PENDING
+  xSemaphoreTake(hdc_handle->lock, portMAX_DELAY);
+  bool detached = (hdc_handle->waiters[slot].in_use && hdc_handle->waiters[slot].task == waiter.task);
+  if(detached){ hdc_handle->waiters[slot].in_use = false; }
+  hdc1080_unlock(hdc_handle);
+  if(detached){ return ESP_ERR_TIMEOUT; }
+  if(ulTaskNotifyTakeIndexed(HDC1080_NOTIFY_INDEX, pdTRUE, timeout) == 0){ return ESP_ERR_TIMEOUT; }
+  return read_err;
+}
+
+/* -------------------------------------------------------------
+ * @name static esp_err_t hdc1080_attach_request(hdc1080_handle_t hdc, const hdc1080_waiter_t * waiter, int * slot)
+ * -------------------------------------------------------------
+ * @brief Start a conversion unless one is in flight and attach
+ * the waiter to it
+ * @param hdc -> the instance, its lock must be held
+ * @param waiter -> the waiter to attach, NULL to attach nothing
+ * @param slot -> filled with the waiter slot used, may be NULL
+ * @returns ESP_OK on success
+ */
+static esp_err_t hdc1080_attach_request(hdc1080_handle_t hdc, const hdc1080_waiter_t * waiter, int * slot){
+  // WHILE CONTINUOUS SAMPLING RUNS THE RESULTS GO TO THE RING, A
+  // MANUAL MEASUREMENT IS ONLY EVER READ BY WHOEVER STARTED IT
+  if(hdc->continuous || hdc->manual){ return ESP_ERR_INVALID_STATE; }
+  int free_slot = -1;
+  if(waiter != NULL){
+    for(int i = 0; i < HDC1080_MAX_WAITERS && free_slot < 0; i++){
+      if(!hdc->waiters[i].in_use){ free_slot = i; }
+    }
+    if(free_slot < 0){ return ESP_ERR_NO_MEM; }
+  }
+  if(!hdc->awaiting_conversion){
+    esp_err_t err_ck = hdc1080_health_gate(hdc, true);
+    if(err_ck == ESP_OK){ err_ck = hdc1080_start_conversion(hdc); }
+    if(err_ck != ESP_OK){ return err_ck; }
+  }
+  if(waiter != NULL){
+    hdc->waiters[free_slot] = *waiter;
+    if(slot != NULL){ *slot = free_slot; }
+  }
+  return ESP_OK;
+}
+
+/* -------------------------------------------------------------
+ * @name static esp_err_t hdc1080_start_conversion(hdc1080_handle_t hdc)
+ * -------------------------------------------------------------
+ * @brief Kickoff the first conversion of a request on the register
+ * matching the configured channel
+ * @param hdc -> the instance to start, its lock must be held
  * @returns ESP_OK on success
  */
-esp_err_t hdc1080_request_readings(void){
-  if(awaiting_conversion){ return HDC1080_CONVERTING; }
+static esp_err_t hdc1080_start_conversion(hdc1080_handle_t hdc){
   /* HDC1080 -> START CONVERSION -> WAIT FOR CONVERSION -> READ SENSOR DATA */
   ESP_LOGD("HDC1080", "STARTING CONVERSION");
-  i2c_cmd_handle_t cmdlnk = i2c_cmd_link_create();
-  check_hdc1080_error(i2c_master_start(cmdlnk));
-  check_hdc1080_error(i2c_master_write_byte(cmdlnk, (hdc1080_set.i2c_address << 1) | I2C_MASTER_WRITE, true));
-  check_hdc1080_error(i2c_master_write_byte(cmdlnk, HDC1080_TEMPERATURE_REG, true));
-  check_hdc1080_error(i2c_master_stop(cmdlnk));
-  esp_err_t err_ck = check_hdc1080_error(i2c_master_cmd_begin(hdc1080_set.i2c_port_number, cmdlnk, hdc1080_set.timeout_length));
-  i2c_cmd_link_delete(cmdlnk);
+  hdc->conversion_started = esp_timer_get_time();
+  hdc->conversion_jitter = 0;
+  memset(&hdc->conversion_raw, 0, sizeof(hdc->conversion_raw));
+  // ONLY A HUMIDITY ONLY REQUEST STARTS ON THE HUMIDITY REGISTER
+  unsigned char trigger_reg = HDC1080_TEMPERATURE_REG;
+  if(hdc->settings.channel == HDC1080_CHANNEL_HUMIDITY){ trigger_reg = HDC1080_HUMIDITY_REG; }
+  esp_err_t err_ck = hdc1080_trigger_conversion(hdc, trigger_reg);
+  if(err_ck == ESP_OK){ HDC1080_COUNT(hdc, conversions_started, 1); }
+  return err_ck;
+}
+
+/* -------------------------------------------------------------
+ * @name static esp_err_t hdc1080_trigger_conversion(hdc1080_handle_t hdc, unsigned char trigger_reg)
+ * -------------------------------------------------------------
+ * @brief Set the register to kickoff the conversion and start
+ * the conversion wait timer
+ * @param hdc -> the instance to start, either its lock is held
+ *        or its conversion is in flight
+ * @param trigger_reg -> HDC1080_TEMPERATURE_REG OR HDC1080_HUMIDITY_REG
+ * @returns ESP_OK on success
+ */
+static esp_err_t hdc1080_trigger_conversion(hdc1080_handle_t hdc, unsigned char trigger_reg){
+  esp_err_t err_ck = check_hdc1080_error(hdc, hdc1080_i2c_transfer(hdc, &trigger_reg, 1, NULL, 0));
   if(err_ck != ESP_OK){ return err_ck; }
-  awaiting_conversion = true;
-  /* START CONVERSION WAIT TIMER */
-  err_ck = esp_timer_start_once(hdc1080_conversion_timer_h, HDC1080_CONVERSION_WAIT_PERIOD);
+  /* START CONVERSION WAIT TIMER, WHEN POLLING THE FIRST
+   * ATTEMPT IS MADE AT HALF THE EXPECTED CONVERSION TIME */
+  unsigned char channel = HDC1080_CHANNEL_TEMPERATURE;
+  if(trigger_reg == HDC1080_HUMIDITY_REG){ channel = HDC1080_CHANNEL_HUMIDITY; }
+  unsigned int wait = hdc1080_channel_conversion_time(hdc->config, channel);
+  if(hdc->settings.completion_mode == HDC1080_COMPLETION_POLL){
+    hdc->conversion_deadline = esp_timer_get_time() + (2 * wait);
+    wait /= 2;
+  }
+  hdc->conversion_reg = trigger_reg;
+  hdc->conversion_ready = esp_timer_get_time() + wait;
+  hdc->awaiting_conversion = true;
+  // A MANUAL MEASUREMENT IS READ BY hdc1080_fetch_measurement, NOT THE TIMER
+  if(hdc->manual){ return ESP_OK; }
+  err_ck = esp_timer_start_once(hdc->conversion_timer_h, wait);
+  if(err_ck != ESP_OK){ hdc->awaiting_conversion = false; }
+  return err_ck;
+}
+
+/* -------------------------------------------------------------
+ * @name esp_err_t hdc1080_start_measurement(hdc1080_handle_t hdc_handle, int64_t * ready_at)
+ * -------------------------------------------------------------
+ * @brief Start a conversion without the conversion timer, the caller
+ * reads it back with hdc1080_fetch_measurement. This is the low level
+ * half of a request for callers that schedule the bus themselves,
+ * like hdc1080_sched, and it runs entirely in the calling task
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param ready_at -> filled with the esp_timer time the result can
+ *        be fetched, may be NULL
+ * @return ESP_OK on success, HDC1080_CONVERTING if a conversion is
+ *         already in flight, ESP_ERR_INVALID_STATE while continuous
+ *         sampling runs
+ */
+esp_err_t hdc1080_start_measurement(hdc1080_handle_t hdc_handle, int64_t * ready_at){
+  if(hdc_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  esp_err_t err_ck = ESP_OK;
+  if(hdc_handle->awaiting_conversion){
+    HDC1080_COUNT(hdc_handle, converting, 1);
+    err_ck = HDC1080_CONVERTING;
+  }else if(hdc_handle->continuous){
+    err_ck = ESP_ERR_INVALID_STATE;
+  }else{
+    err_ck = hdc1080_health_gate(hdc_handle, true);
+    if(err_ck == ESP_OK){
+      hdc_handle->manual = true;
+      err_ck = hdc1080_start_conversion(hdc_handle);
+      if(err_ck != ESP_OK){ hdc_handle->manual = false; }
+    }
+    if(err_ck == ESP_OK && ready_at != NULL){ *ready_at = hdc_handle->conversion_ready; }
+  }
+  hdc1080_unlock(hdc_handle);
+  return err_ck;
+}
+
+/* -------------------------------------------------------------
+ * @name esp_err_t hdc1080_fetch_measurement(hdc1080_handle_t hdc_handle, hdc1080_raw_readings_t * raw, int64_t * ready_at)
+ * -------------------------------------------------------------
+ * @brief Read back a conversion started by hdc1080_start_measurement
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param raw -> filled with the raw codes once the measurement is done
+ * @param ready_at -> when HDC1080_CONVERTING is returned, filled with
+ *        the esp_timer time to fetch again, may be NULL
+ * @return ESP_OK with raw filled, HDC1080_CONVERTING when the HDC1080
+ *         is still converting while polling or the humidity conversion
+ *         of an HDC1080_CHANNEL_BOTH request in separate mode was just
+ *         started, ESP_ERR_INVALID_STATE if no measurement was started,
+ *         otherwise the read error. Any result other than
+ *         HDC1080_CONVERTING ends the measurement
+ */
+esp_err_t hdc1080_fetch_measurement(hdc1080_handle_t hdc_handle, hdc1080_raw_readings_t * raw, int64_t * ready_at){
+  if(hdc_handle == NULL || raw == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  if(!hdc_handle->manual || !hdc_handle->awaiting_conversion){
+    hdc1080_unlock(hdc_handle);
+    return ESP_ERR_INVALID_STATE;
+  }
+  esp_err_t err_ck = hdc1080_read_conversion(hdc_handle);
+  if(err_ck == HDC1080_CONVERTING){
+    if(ready_at != NULL){ *ready_at = hdc_handle->conversion_ready; }
+    hdc1080_unlock(hdc_handle);
+    return err_ck;
+  }
+  hdc1080_record_latency(hdc_handle);
+  memset(raw, 0, sizeof(hdc1080_raw_readings_t));
+  if(err_ck == ESP_OK){
+    HDC1080_COUNT(hdc_handle, conversions_completed, 1);
+    *raw = hdc_handle->conversion_raw;
+  }
+  hdc_handle->awaiting_conversion = false;
+  hdc_handle->manual = false;
+  hdc1080_unlock(hdc_handle);
+  return err_ck;
+}
+
+/* -------------------------------------------------------------
+ * @name esp_err_t hdc1080_abort_measurement(hdc1080_handle_t hdc_handle)
+ * -------------------------------------------------------------
+ * @brief Give up on a conversion started by hdc1080_start_measurement
+ * without reading it, e.g. when the device could not be reached
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no measurement
+ *         was started
+ */
+esp_err_t hdc1080_abort_measurement(hdc1080_handle_t hdc_handle){
+  if(hdc_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  esp_err_t err_ck = ESP_ERR_INVALID_STATE;
+  if(hdc_handle->manual && hdc_handle->awaiting_conversion){
+    hdc_handle->awaiting_conversion = false;
+    hdc_handle->manual = false;
+    err_ck = ESP_OK;
+  }
+  hdc1080_unlock(hdc_handle);
   return err_ck;
 }
 
 /* --------------------------------------------------------------------------------------------------
- * @name esp_err_t hdc1080_configure(hdc1080_settings_t * hdc1080_settings, hdc1080_config_t hdc_cfg)
+ * @name esp_err_t hdc1080_configure(hdc1080_settings_t * hdc1080_settings, hdc1080_config_t hdc_cfg, hdc1080_handle_t * hdc_handle)
  * --------------------------------------------------------------------------------------------------
- * @brief Set HDC1080 config registers
+ * @brief Create a new HDC1080 instance and set its config registers
  * @param hdc1080_settings -> Pointer to the hdc1080_settings_t struct
  * @param hdc_cfg - Device configuration from the hdc1080_config_t struct
- * @return ESP_OK on success* 
+ * @param hdc_handle -> Filled with the handle of the new instance
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown sink,
+ *         completion_mode or channel, ESP_ERR_INVALID_SIZE for a
+ *         sample_buffer_length that is not a power of 2, otherwise
+ *         the error of the failed bring up step
  * @note The i2c bus must be setup and configured before
- *       calling this routine
+ *       calling this routine. Every handle owns its own settings,
+ *       timer and conversion state, release it with hdc1080_delete
  */
-esp_err_t hdc1080_configure(hdc1080_settings_t * hdc1080_settings, hdc1080_config_t hdc_cfg){
-  if(awaiting_conversion){ return HDC1080_CONVERTING; }
-  unsigned char hdc_buff[2] = {0};
-  unsigned short cfg_s = 0;
-  cfg_s = (hdc_cfg.config_register << 8);
-  // CAPTURE THE SETTINGS TO THE FILE GLOBAL SCOPE
-  memmove(&hdc1080_set, hdc1080_settings, sizeof(hdc1080_settings_t));
-  // GET MANUFACTURER ID AND ENSURE A MATCH
-  esp_err_t err_ck = check_hdc1080_error(read_hdc100_data(HDC1080_MANUFACTURER_ID_REG, hdc_buff, 2));
-  if(err_ck != ESP_OK){ return err_ck; }
-  if((unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]) != HDC1080_MANUFACTURER_ID){
-    // NOT A TI CHIP
-    ESP_LOGE("HDC1080", "EXPECTED TI ID 0x%04X BUT GOT 0x%04X", HDC1080_MANUFACTURER_ID, (unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]));
-    return HDC1080_ERR_ID;
+esp_err_t hdc1080_configure(hdc1080_settings_t * hdc1080_settings, hdc1080_config_t hdc_cfg, hdc1080_handle_t * hdc_handle){
+  if(hdc1080_settings == NULL || hdc_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  // THE RING LENGTH MUST BE A POWER OF 2 SO THE INDEXES CAN BE MASKED
+  if((hdc1080_settings->sample_buffer_length & (hdc1080_settings->sample_buffer_length - 1)) != 0){ return ESP_ERR_INVALID_SIZE; }
+  if(hdc1080_settings->sink > HDC1080_SINK_EVENT || hdc1080_settings->completion_mode > HDC1080_COMPLETION_POLL){ return ESP_ERR_INVALID_ARG; }
+  if(hdc1080_settings->sink == HDC1080_SINK_QUEUE && hdc1080_settings->readings_queue == NULL){ return ESP_ERR_INVALID_ARG; }
+  // A SINGLE CHANNEL CAN ONLY BE MEASURED IN SEPARATE MODE
+  if(hdc1080_settings->channel > HDC1080_CHANNEL_HUMIDITY){ return ESP_ERR_INVALID_ARG; }
+  if(hdc1080_settings->channel != HDC1080_CHANNEL_BOTH && hdc_cfg.mode_of_acquisition == HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_filter_valid(&hdc1080_settings->filter)){ return ESP_ERR_INVALID_ARG; }
+  hdc1080_handle_t hdc = calloc(1, sizeof(struct hdc1080_dev_t));
+  if(hdc == NULL){ return ESP_ERR_NO_MEM; }
+  // CAPTURE THE SETTINGS TO THE INSTANCE
+  memmove(&hdc->settings, hdc1080_settings, sizeof(hdc1080_settings_t));
+  hdc->config = hdc_cfg;
+  hdc->conversion_wait = hdc1080_channel_conversion_time(hdc_cfg, hdc->settings.channel);
+  hdc->lock = xSemaphoreCreateMutex();
+  if(hdc->lock == NULL){
+    free(hdc);
+    return ESP_ERR_NO_MEM;
   }
-  // GET THE DEVICE ID AND MAKE SURE IT'S AN HDC1080
-  err_ck = check_hdc1080_error(read_hdc100_data(HDC1080_DEVICE_ID_REG, hdc_buff, 2));
-  if(err_ck != ESP_OK){ return err_ck; }
-  if((unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]) != HDC1080_DEVICE_ID){
-    // NOT AND HDC1080
-    ESP_LOGE("HDC1080", "EXPECTED DEVICE ID 0x%04X BUT GOT 0x%04X", HDC1080_DEVICE_ID, (unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]));
-    return HDC1080_ERR_ID;  
+  esp_err_t err_ck = ESP_OK;
+  if(hdc->settings.sample_buffer_length > 0){
+    hdc->samples = calloc(hdc->settings.sample_buffer_length, sizeof(hdc1080_sample_t));
+    if(hdc->samples == NULL){
+      err_ck = ESP_ERR_NO_MEM;
+      goto configure_failed;
+    }
+    hdc->samples_mask = hdc->settings.sample_buffer_length - 1;
   }
-  // GET THE CURRENT CONFIGURATION AND IF IT DOESN'T MATCH, UPDATE IT
-  err_ck = check_hdc1080_error(read_hdc100_data(HDC1080_CONFIG_REG, hdc_buff, 2));
-  if(err_ck != ESP_OK){ return err_ck; }
-  ESP_LOGD("HDC1080", "CURRENT CONFIGURATION 0x%04X", (unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]));
-  if((unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]) != cfg_s){
-    ESP_LOGD("HDC1080", "UPDATING CONFIGURATION FROM 0x%04X TO 0x%04X", (unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]), cfg_s);
-    hdc_buff[0] = hdc_cfg.config_register;
-    hdc_buff[1] = 0;
-    err_ck = check_hdc1080_error(write_hdc100_data(HDC1080_CONFIG_REG, hdc_buff, 2));
-    if(err_ck != ESP_OK){ return err_ck; }
+  if(hdc1080_warm_start_valid(&hdc->settings)){
+    // WOKEN FROM DEEP SLEEP, THE CACHE ALREADY VOUCHES FOR THE IDS AND THE CONFIG
+    ESP_LOGD("HDC1080", "WARM START, IDENTITY TAKEN FROM THE CACHE");
+    hdc->serial_id = hdc->settings.warm_start->serial_id;
+    hdc->serial_known = true;
+    if(hdc->settings.warm_start->config_register != hdc_cfg.config_register){
+      err_ck = hdc1080_write_configuration(hdc, hdc_cfg, false);
+    }
+  }else{
+    err_ck = hdc1080_verify_identity(hdc);
+    if(err_ck == ESP_OK){ err_ck = hdc1080_write_configuration(hdc, hdc_cfg, true); }
   }
+  if(err_ck != ESP_OK){ goto configure_failed; }
   /* HDC1080 REQUIRES A SHORT DELAY TO PERFORM CONVERSION
    * BEFORE SENSOR DATA CAN BE READ. THE TIMER BELOW IS USED
    * WHEN TEMP READINGS ARE REQUESTED */
   const esp_timer_create_args_t hdc1080_conversion_timer_args = {
     .callback = &hdc1080_conversion_completed,
+    .arg = hdc,
     .name = "hdc1080_conversion_timer"
   };
   /* CREATE THE TEMPERATURE TRIGGER TIMER */
-  err_ck = esp_timer_create(&hdc1080_conversion_timer_args, &hdc1080_conversion_timer_h);
+  err_ck = esp_timer_create(&hdc1080_conversion_timer_args, &hdc->conversion_timer_h);
+  if(err_ck != ESP_OK){ goto configure_failed; }
+  /* OPTIONALLY MOVE THE READ OUT OF THE esp_timer TASK */
+  if(hdc->settings.use_worker_task){
+    err_ck = hdc1080_start_worker(hdc);
+    if(err_ck != ESP_OK){
+      esp_timer_delete(hdc->conversion_timer_h);
+      goto configure_failed;
+    }
+  }
+  // ONLY A SENSOR THAT CAME UP COMPLETELY IS CACHED
+  hdc1080_store_warm_start(hdc);
+  *hdc_handle = hdc;
+  return ESP_OK;
+
+configure_failed:
+  // THE CONFIG MAY HAVE BEEN WRITTEN ALREADY, A STALE CACHE WOULD SKIP WRITING IT NEXT TIME
+  if(hdc->settings.warm_start != NULL){ memset(hdc->settings.warm_start, 0, sizeof(hdc1080_warm_start_t)); }
+  vSemaphoreDelete(hdc->lock);
+  free(hdc->samples);
+  free(hdc);
+  return err_ck;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name esp_err_t hdc1080_configure_all(hdc1080_settings_t * hdc1080_settings, const hdc1080_config_t * hdc_cfgs, hdc1080_handle_t * hdc_handles, esp_err_t * results, size_t count)
+ * --------------------------------------------------------------------------------------------------
+ * @brief hdc1080_configure a batch of sensors, the ports are brought up
+ * in parallel with one task per extra port, the sensors on each port
+ * one after another. The calling task takes the first port
+ * @param hdc1080_settings -> array of count settings
+ * @param hdc_cfgs -> array of count register configurations
+ * @param hdc_handles -> array of count, filled with the new instances,
+ *        NULL for a sensor that failed
+ * @param results -> array of count, filled with each hdc1080_configure
+ *        result, may be NULL
+ * @param count -> number of sensors, at least 1
+ * @return ESP_OK when every sensor was configured, ESP_ERR_INVALID_ARG
+ *         for a NULL array or a count of 0, otherwise the first
+ *         failure in array order
+ * @note Sensors with the same i2c_port_number, or the same bus backend,
+ *       share a port. A port task that cannot be created runs its port
+ *       on the calling task instead
+ */
+esp_err_t hdc1080_configure_all(hdc1080_settings_t * hdc1080_settings, const hdc1080_config_t * hdc_cfgs, hdc1080_handle_t * hdc_handles, esp_err_t * results, size_t count){
+  if(hdc1080_settings == NULL || hdc_cfgs == NULL || hdc_handles == NULL || count == 0){ return ESP_ERR_INVALID_ARG; }
+  esp_err_t * port_results = results;
+  if(port_results == NULL){ port_results = calloc(count, sizeof(esp_err_t)); }
+  hdc1080_probe_job_t * jobs = calloc(count, sizeof(hdc1080_probe_job_t));
+  SemaphoreHandle_t done = xSemaphoreCreateCounting(count, 0);
+  if(port_results == NULL || jobs == NULL || done == NULL){
+    if(done != NULL){ vSemaphoreDelete(done); }
+    free(jobs);
+    if(port_results != results){ free(port_results); }
+    return ESP_ERR_NO_MEM;
+  }
+  // ONE JOB PER PORT, LED BY THE FIRST SENSOR ON IT
+  size_t job_count = 0;
+  for(size_t i = 0; i < count; i++){
+    bool leader = true;
+    for(size_t j = 0; j < i && leader; j++){ leader = !hdc1080_same_port(&hdc1080_settings[i], &hdc1080_settings[j]); }
+    if(!leader){ continue; }
+    jobs[job_count++] = (hdc1080_probe_job_t){
+      .settings = hdc1080_settings,
+      .cfgs = hdc_cfgs,
+      .handles = hdc_handles,
+      .results = port_results,
+      .count = count,
+      .leader = i
+    };
+  }
+  size_t spawned = 0;
+  for(size_t i = 1; i < job_count; i++){
+    jobs[i].done = done;
+    if(xTaskCreate(hdc1080_probe_task, "hdc1080_probe", HDC1080_PROBE_STACK_SIZE, &jobs[i], uxTaskPriorityGet(NULL), NULL) == pdPASS){
+      spawned++;
+    }else{
+      jobs[i].done = NULL;
+    }
+  }
+  for(size_t i = 0; i < job_count; i++){
+    if(jobs[i].done == NULL){ hdc1080_probe_port(&jobs[i]); }
+  }
+  for(size_t i = 0; i < spawned; i++){ xSemaphoreTake(done, portMAX_DELAY); }
+  vSemaphoreDelete(done);
+  free(jobs);
+  esp_err_t err_ck = ESP_OK;
+  for(size_t i = 0; i < count && err_ck == ESP_OK; i++){ err_ck = port_results[i]; }
+  if(port_results != results){ free(port_results); }
   return err_ck;
 }
 
+/* --------------------------------------------------------------------------------------------------
+ * @name static void hdc1080_probe_port(hdc1080_probe_job_t * job)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Configure every sensor on the port of job->leader in order
+ * @param job -> the port to bring up
+ */
+static void hdc1080_probe_port(hdc1080_probe_job_t * job){
+  for(size_t i = job->leader; i < job->count; i++){
+    if(!hdc1080_same_port(&job->settings[i], &job->settings[job->leader])){ continue; }
+    job->handles[i] = NULL;
+    job->results[i] = hdc1080_configure(&job->settings[i], job->cfgs[i], &job->handles[i]);
+  }
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static void hdc1080_probe_task(void * arg)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Port task of hdc1080_configure_all
+ * @param arg -> the hdc1080_probe_job_t to run
+ */
+static void hdc1080_probe_task(void * arg){
+  hdc1080_probe_job_t * job = (hdc1080_probe_job_t *)arg;
+  hdc1080_probe_port(job);
+  xSemaphoreGive(job->done);
+  vTaskDelete(NULL);
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static bool hdc1080_same_port(const hdc1080_settings_t * a, const hdc1080_settings_t * b)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Tell whether two sensors share a bus
+ * @return true for the same bus backend, or the same i2c port when
+ *         both use the esp-idf i2c driver
+ */
+static bool hdc1080_same_port(const hdc1080_settings_t * a, const hdc1080_settings_t * b){
+  if(a->bus.transfer != b->bus.transfer){ return false; }
+  if(a->bus.transfer != NULL){ return (a->bus.bus_ctx == b->bus.bus_ctx); }
+  return (a->i2c_port_number == b->i2c_port_number);
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_timer_fence(void* arg)
+ * -------------------------------------------------------------
+ * @brief callback of the throw away timer hdc1080_delete queues
+ * behind any timer callback still running for the handle
+ * @param arg -> the task waiting in hdc1080_delete
+ */
+static void hdc1080_timer_fence(void* arg){
+  xTaskNotifyGiveIndexed((TaskHandle_t)arg, HDC1080_NOTIFY_INDEX);
+}
+
 /* ----------------------------------------------------------------------
- * @name esp_err_t hdc1080_get_configuration(hdc1080_config_t * hdc_cfg)
+ * @name esp_err_t hdc1080_delete(hdc1080_handle_t hdc_handle)
  * ----------------------------------------------------------------------
- * @brief Write to the i2c bus
+ * @brief Release an instance created by hdc1080_configure
+ * @param hdc_handle -> handle to release
+ * @return ESP_OK on success, HDC1080_CONVERTING if a conversion
+ *         is still in flight or its readings are being delivered,
+ *         ESP_ERR_INVALID_STATE if continuous sampling has not been
+ *         stopped, the esp_timer error if a timer could not be
+ *         stopped or deleted, the handle stays valid on any error
+ * @note Blocks until every timer callback and the worker task are
+ *       done with the handle, so it must not be called from the
+ *       readings callbacks or the esp_timer task. The calling task
+ *       waits on its HDC1080_NOTIFY_INDEX task notification
+ */
+esp_err_t hdc1080_delete(hdc1080_handle_t hdc_handle){
+  if(hdc_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  if(hdc_handle->awaiting_conversion || atomic_load_explicit(&hdc_handle->delivering, memory_order_acquire)){
+    hdc1080_unlock(hdc_handle);
+    HDC1080_COUNT(hdc_handle, converting, 1);
+    return HDC1080_CONVERTING;
+  }
+  if(hdc_handle->continuous){
+    hdc1080_unlock(hdc_handle);
+    return ESP_ERR_INVALID_STATE;
+  }
+  // NEITHER TIMER MAY FIRE AGAIN, ONE THAT IS NOT RUNNING IS FINE
+  esp_err_t err_ck = ESP_OK;
+  if(hdc_handle->sample_timer_h != NULL){ err_ck = esp_timer_stop(hdc_handle->sample_timer_h); }
+  if(err_ck == ESP_OK || err_ck == ESP_ERR_INVALID_STATE){ err_ck = esp_timer_stop(hdc_handle->conversion_timer_h); }
+  hdc1080_unlock(hdc_handle);
+  if(err_ck != ESP_OK && err_ck != ESP_ERR_INVALID_STATE){
+    ESP_LOGE("HDC1080", "DELETE COULD NOT STOP A TIMER %s", esp_err_to_name(err_ck));
+    return err_ck;
+  }
+  // A SLOT CALLBACK MAY ALREADY BE BLOCKED ON THE LOCK, THE esp_timer TASK
+  // RUNS CALLBACKS IN ORDER SO ONCE THIS ONE FIRES IT HAS RETURNED
+  esp_timer_handle_t fence_h = NULL;
+  const esp_timer_create_args_t hdc1080_fence_timer_args = {
+    .callback = &hdc1080_timer_fence,
+    .arg = xTaskGetCurrentTaskHandle(),
+    .name = "hdc1080_fence_timer"
+  };
+  ulTaskNotifyValueClearIndexed(NULL, HDC1080_NOTIFY_INDEX, UINT32_MAX);
+  err_ck = esp_timer_create(&hdc1080_fence_timer_args, &fence_h);
+  if(err_ck != ESP_OK){ return err_ck; }
+  err_ck = esp_timer_start_once(fence_h, 0);
+  if(err_ck == ESP_OK){ ulTaskNotifyTakeIndexed(HDC1080_NOTIFY_INDEX, pdTRUE, portMAX_DELAY); }
+  esp_timer_delete(fence_h);
+  if(err_ck != ESP_OK){ return err_ck; }
+  if(hdc_handle->sample_timer_h != NULL){
+    err_ck = esp_timer_delete(hdc_handle->sample_timer_h);
+    if(err_ck != ESP_OK){ return err_ck; }
+    hdc_handle->sample_timer_h = NULL;
+  }
+  err_ck = esp_timer_delete(hdc_handle->conversion_timer_h);
+  if(err_ck != ESP_OK){ return err_ck; }
+  // THE WORKER FINISHES WHATEVER IT IS ON BEFORE IT SEES THE EXIT
+  if(hdc_handle->worker_h != NULL){
+    hdc_handle->deleter = xTaskGetCurrentTaskHandle();
+    xTaskNotify(hdc_handle->worker_h, HDC1080_WORKER_EXIT, eSetBits);
+    ulTaskNotifyTakeIndexed(HDC1080_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+  }
+  vSemaphoreDelete(hdc_handle->lock);
+  free(hdc_handle->samples);
+  free(hdc_handle);
+  return ESP_OK;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_set_channel(hdc1080_handle_t hdc_handle, unsigned char channel)
+ * ----------------------------------------------------------------------
+ * @brief Change what the following requests measure
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param channel -> HDC1080_CHANNEL_BOTH, HDC1080_CHANNEL_TEMPERATURE
+ *        OR HDC1080_CHANNEL_HUMIDITY
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a single channel
+ *         in HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE mode,
+ *         HDC1080_CONVERTING if a conversion is in flight,
+ *         ESP_ERR_INVALID_STATE while continuous sampling runs
+ */
+esp_err_t hdc1080_set_channel(hdc1080_handle_t hdc_handle, unsigned char channel){
+  if(hdc_handle == NULL || channel > HDC1080_CHANNEL_HUMIDITY){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  if(hdc_handle->awaiting_conversion){
+    hdc1080_unlock(hdc_handle);
+    HDC1080_COUNT(hdc_handle, converting, 1);
+    return HDC1080_CONVERTING;
+  }
+  // THE SAMPLE PERIOD WAS CHECKED AGAINST THE CURRENT CHANNEL
+  if(hdc_handle->continuous){
+    hdc1080_unlock(hdc_handle);
+    return ESP_ERR_INVALID_STATE;
+  }
+  // THE MODE IS READ UNDER THE LOCK, hdc1080_set_configuration MAY BE CHANGING IT
+  if(channel != HDC1080_CHANNEL_BOTH && hdc_handle->config.mode_of_acquisition == HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE){
+    hdc1080_unlock(hdc_handle);
+    return ESP_ERR_INVALID_ARG;
+  }
+  // THE FILTER STATE HOLDS CODES OF THE OLD CHANNEL
+  if(hdc_handle->settings.channel != channel){ hdc1080_filter_reset(&hdc_handle->filter_state); }
+  hdc_handle->settings.channel = channel;
+  hdc_handle->conversion_wait = hdc1080_channel_conversion_time(hdc_handle->config, channel);
+  hdc1080_unlock(hdc_handle);
+  return ESP_OK;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_set_filter(hdc1080_handle_t hdc_handle, const hdc1080_filter_t * filter)
+ * ----------------------------------------------------------------------
+ * @brief Replace the readings filter, the filter starts over with
+ * the next conversion
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param filter -> the new filter settings, all 0 disables filtering
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG when a setting is
+ *         out of range
+ * @note Can be called at any time, also while continuous sampling
+ *       runs, a conversion in flight is filtered with the new settings
+ */
+esp_err_t hdc1080_set_filter(hdc1080_handle_t hdc_handle, const hdc1080_filter_t * filter){
+  if(hdc_handle == NULL || !hdc1080_filter_valid(filter)){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  hdc_handle->settings.filter = *filter;
+  hdc1080_filter_reset(&hdc_handle->filter_state);
+  hdc1080_unlock(hdc_handle);
+  return ESP_OK;
+}
+
+/* ----------------------------------------------------------------------
+ * @name unsigned int hdc1080_conversion_time(hdc1080_config_t hdc_cfg)
+ * ----------------------------------------------------------------------
+ * @brief Work out how long a request for both channels takes
+ * @param hdc_cfg -> the register configuration to time
+ * @return the conversion wait in microseconds including
+ *         HDC1080_CONVERSION_MARGIN
+ */
+unsigned int hdc1080_conversion_time(hdc1080_config_t hdc_cfg){
+  return hdc1080_channel_conversion_time(hdc_cfg, HDC1080_CHANNEL_BOTH);
+}
+
+/* ----------------------------------------------------------------------
+ * @name unsigned int hdc1080_channel_conversion_time(hdc1080_config_t hdc_cfg, unsigned char channel)
+ * ----------------------------------------------------------------------
+ * @brief Work out how long a request for a channel takes
+ * @param hdc_cfg -> the register configuration to time
+ * @param channel -> HDC1080_CHANNEL_BOTH, HDC1080_CHANNEL_TEMPERATURE
+ *        OR HDC1080_CHANNEL_HUMIDITY
+ * @return the conversion wait in microseconds including
+ *         HDC1080_CONVERSION_MARGIN for every conversion started
+ * @note In HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE mode both
+ *       conversions always run back to back and channel is ignored
+ */
+unsigned int hdc1080_channel_conversion_time(hdc1080_config_t hdc_cfg, unsigned char channel){
+  unsigned int temperature_wait = HDC1080_TEMPERATURE_CONVERSION_14BIT;
+  unsigned int humidity_wait = HDC1080_HUMIDITY_CONVERSION_14BIT;
+  if(hdc_cfg.temperature_measurement_resolution == HDC1080_TEMPERATURE_RESOLUTION_11BIT){
+    temperature_wait = HDC1080_TEMPERATURE_CONVERSION_11BIT;
+  }
+  switch(hdc_cfg.humidity_measurement_resolution){
+    case HDC1080_HUMIDITY_RESOLUTION_8BIT: humidity_wait = HDC1080_HUMIDITY_CONVERSION_8BIT; break;
+    case HDC1080_HUMIDITY_RESOLUTION_11BIT: humidity_wait = HDC1080_HUMIDITY_CONVERSION_11BIT; break;
+    default: break;
+  }
+  if(hdc_cfg.mode_of_acquisition == HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE){
+    return HDC1080_CONVERSION_MARGIN + temperature_wait + humidity_wait;
+  }
+  switch(channel){
+    case HDC1080_CHANNEL_TEMPERATURE: return HDC1080_CONVERSION_MARGIN + temperature_wait;
+    case HDC1080_CHANNEL_HUMIDITY: return HDC1080_CONVERSION_MARGIN + humidity_wait;
+    default: return (2 * HDC1080_CONVERSION_MARGIN) + temperature_wait + humidity_wait;  /* TWO CONVERSIONS */
+  }
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_get_configuration(hdc1080_handle_t hdc_handle, hdc1080_config_t * hdc_cfg)
+ * ----------------------------------------------------------------------
+ * @brief Read the current configuration register
+ * @param hdc_handle -> handle returned from hdc1080_configure
  * @param hdc_cfg -> pointer to an hdc1080_config_t to fill
  * @return ESP_OK on success* 
  */
-esp_err_t hdc1080_get_configuration(hdc1080_config_t * hdc_cfg){
-  if(awaiting_conversion){ return HDC1080_CONVERTING; }
+esp_err_t hdc1080_get_configuration(hdc1080_handle_t hdc_handle, hdc1080_config_t * hdc_cfg){
+  if(hdc_handle == NULL || hdc_cfg == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  if(hdc_handle->awaiting_conversion){
+    hdc1080_unlock(hdc_handle);
+    HDC1080_COUNT(hdc_handle, converting, 1);
+    return HDC1080_CONVERTING;
+  }
   unsigned char hdc_buff[2] = {0};
-  esp_err_t err_ck = check_hdc1080_error(read_hdc100_data(HDC1080_CONFIG_REG, hdc_buff, 2));
+  esp_err_t err_ck = hdc1080_health_gate(hdc_handle, true);
+  if(err_ck == ESP_OK){ err_ck = check_hdc1080_error(hdc_handle, read_hdc100_data(hdc_handle, HDC1080_CONFIG_REG, hdc_buff, 2)); }
+  hdc1080_unlock(hdc_handle);
   if(err_ck != ESP_OK){ return err_ck; }
   hdc_cfg->config_register = hdc_buff[0];
   return err_ck;
 }
 
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_set_configuration(hdc1080_handle_t hdc_handle, hdc1080_config_t hdc_cfg)
+ * ----------------------------------------------------------------------
+ * @brief Write a new config register, the instance keeps its timers,
+ * worker task and sample ring so there is no need to delete and
+ * configure again. The warm start cache follows the change
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param hdc_cfg -> the new register configuration
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG when the channel
+ *         setting needs HDC1080_ACQUISITION_HUMIDITY_OR_TEMPERATURE,
+ *         HDC1080_CONVERTING if a conversion is in flight,
+ *         ESP_ERR_INVALID_STATE while continuous sampling runs
+ */
+esp_err_t hdc1080_set_configuration(hdc1080_handle_t hdc_handle, hdc1080_config_t hdc_cfg){
+  if(hdc_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  if(hdc_handle->awaiting_conversion){
+    hdc1080_unlock(hdc_handle);
+    HDC1080_COUNT(hdc_handle, converting, 1);
+    return HDC1080_CONVERTING;
+  }
+  // THE SAMPLE PERIOD WAS CHECKED AGAINST THE CURRENT CONVERSION TIME
+  if(hdc_handle->continuous){
+    hdc1080_unlock(hdc_handle);
+    return ESP_ERR_INVALID_STATE;
+  }
+  // THE CHANNEL IS READ UNDER THE LOCK, hdc1080_set_channel MAY BE CHANGING IT
+  if(hdc_handle->settings.channel != HDC1080_CHANNEL_BOTH && hdc_cfg.mode_of_acquisition == HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE){
+    hdc1080_unlock(hdc_handle);
+    return ESP_ERR_INVALID_ARG;
+  }
+  esp_err_t err_ck = hdc1080_health_gate(hdc_handle, true);
+  if(err_ck == ESP_OK){ err_ck = hdc1080_write_configuration(hdc_handle, hdc_cfg, false); }
+  if(err_ck == ESP_OK){
+    hdc_handle->config = hdc_cfg;
+    hdc_handle->conversion_wait = hdc1080_channel_conversion_time(hdc_cfg, hdc_handle->settings.channel);
+    hdc1080_store_warm_start(hdc_handle);
+  }
+  hdc1080_unlock(hdc_handle);
+  return err_ck;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_get_serial_id(hdc1080_handle_t hdc_handle, uint64_t * serial_id)
+ * ----------------------------------------------------------------------
+ * @brief Get the 41 bit serial of the HDC1080, read once and then
+ * answered from memory, or from the warm start cache
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param serial_id -> filled with the serial
+ * @return ESP_OK on success, HDC1080_CONVERTING if the serial still
+ *         has to be read and a conversion is in flight
+ */
+esp_err_t hdc1080_get_serial_id(hdc1080_handle_t hdc_handle, uint64_t * serial_id){
+  if(hdc_handle == NULL || serial_id == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  esp_err_t err_ck = ESP_OK;
+  if(!hdc_handle->serial_known){
+    if(hdc_handle->awaiting_conversion){
+      HDC1080_COUNT(hdc_handle, converting, 1);
+      err_ck = HDC1080_CONVERTING;
+    }else{
+      err_ck = hdc1080_health_gate(hdc_handle, true);
+      if(err_ck == ESP_OK){ err_ck = hdc1080_read_serial_id(hdc_handle); }
+    }
+  }
+  if(err_ck == ESP_OK){ *serial_id = hdc_handle->serial_id; }
+  hdc1080_unlock(hdc_handle);
+  return err_ck;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_get_stats(hdc1080_handle_t hdc_handle, hdc1080_stats_t * stats)
+ * ----------------------------------------------------------------------
+ * @brief Copy out the runtime counters of an instance
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param stats -> filled with the counters
+ * @return ESP_OK on success
+ * @note Lock free and safe from any task, the counters are read one
+ *       by one so a conversion finishing meanwhile may show up in
+ *       some of them only. bus_time wraps after about 71 minutes of
+ *       accumulated bus time
+ */
+esp_err_t hdc1080_get_stats(hdc1080_handle_t hdc_handle, hdc1080_stats_t * stats){
+  if(hdc_handle == NULL || stats == NULL){ return ESP_ERR_INVALID_ARG; }
+  hdc1080_counters_t * counters = &hdc_handle->counters;
+  stats->conversions_started = atomic_load_explicit(&counters->conversions_started, memory_order_relaxed);
+  stats->conversions_completed = atomic_load_explicit(&counters->conversions_completed, memory_order_relaxed);
+  stats->retries = atomic_load_explicit(&counters->retries, memory_order_relaxed);
+  stats->errors_nack = atomic_load_explicit(&counters->errors_nack, memory_order_relaxed);
+  stats->errors_timeout = atomic_load_explicit(&counters->errors_timeout, memory_order_relaxed);
+  stats->errors_invalid_state = atomic_load_explicit(&counters->errors_invalid_state, memory_order_relaxed);
+  stats->errors_other = atomic_load_explicit(&counters->errors_other, memory_order_relaxed);
+  stats->converting = atomic_load_explicit(&counters->converting, memory_order_relaxed);
+  stats->sink_dropped = atomic_load_explicit(&counters->sink_dropped, memory_order_relaxed);
+  stats->decimated = atomic_load_explicit(&counters->decimated, memory_order_relaxed);
+  stats->suppressed = atomic_load_explicit(&counters->suppressed, memory_order_relaxed);
+  stats->samples_dropped = atomic_load_explicit(&counters->samples_dropped, memory_order_relaxed);
+  stats->bus_transactions = atomic_load_explicit(&counters->bus_transactions, memory_order_relaxed);
+  stats->bus_time = atomic_load_explicit(&counters->bus_time, memory_order_relaxed);
+  stats->latency_max = atomic_load_explicit(&counters->latency_max, memory_order_relaxed);
+  stats->missed_slots = atomic_load_explicit(&counters->missed_slots, memory_order_relaxed);
+  stats->jitter_max = atomic_load_explicit(&counters->jitter_max, memory_order_relaxed);
+  stats->fast_failed = atomic_load_explicit(&counters->fast_failed, memory_order_relaxed);
+  stats->recoveries = atomic_load_explicit(&counters->recoveries, memory_order_relaxed);
+  stats->recoveries_failed = atomic_load_explicit(&counters->recoveries_failed, memory_order_relaxed);
+  for(int i = 0; i < HDC1080_LATENCY_BUCKETS; i++){
+    stats->latency[i] = atomic_load_explicit(&counters->latency[i], memory_order_relaxed);
+  }
+  return ESP_OK;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_reset_stats(hdc1080_handle_t hdc_handle)
+ * ----------------------------------------------------------------------
+ * @brief Zero the runtime counters of an instance
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @return ESP_OK on success
+ */
+esp_err_t hdc1080_reset_stats(hdc1080_handle_t hdc_handle){
+  if(hdc_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  hdc1080_counters_t * counters = &hdc_handle->counters;
+  atomic_store_explicit(&counters->conversions_started, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->conversions_completed, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->retries, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->errors_nack, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->errors_timeout, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->errors_invalid_state, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->errors_other, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->converting, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->sink_dropped, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->decimated, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->suppressed, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->samples_dropped, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->bus_transactions, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->bus_time, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->latency_max, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->missed_slots, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->jitter_max, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->fast_failed, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->recoveries, 0, memory_order_relaxed);
+  atomic_store_explicit(&counters->recoveries_failed, 0, memory_order_relaxed);
+  for(int i = 0; i < HDC1080_LATENCY_BUCKETS; i++){
+    atomic_store_explicit(&counters->latency[i], 0, memory_order_relaxed);
+  }
+  return ESP_OK;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_get_health(hdc1080_handle_t hdc_handle, hdc1080_health_state_t * health)
+ * ----------------------------------------------------------------------
+ * @brief Get the bus health of a sensor, e.g. to skip a mux switch
+ * for a sensor that would fail fast anyway
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @param health -> filled with the health
+ * @return ESP_OK on success
+ */
+esp_err_t hdc1080_get_health(hdc1080_handle_t hdc_handle, hdc1080_health_state_t * health){
+  if(hdc_handle == NULL || health == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  health->down = hdc_handle->health_down;
+  health->failures = hdc_handle->health_failures;
+  health->retry_at = hdc_handle->health_retry_at;
+  hdc1080_unlock(hdc_handle);
+  return ESP_OK;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_recover(hdc1080_handle_t hdc_handle)
+ * ----------------------------------------------------------------------
+ * @brief Clear the bus, soft reset the HDC1080 and restore its config
+ * right away, without waiting for the backoff to run out. The health
+ * tracking does the same on its own once a sensor is down
+ * @param hdc_handle -> handle returned from hdc1080_configure
+ * @return ESP_OK when the sensor answers again, HDC1080_CONVERTING if
+ *         a conversion is in flight, otherwise the step that failed
+ * @note Blocks for HDC1080_RESET_TIME
+ */
+esp_err_t hdc1080_recover(hdc1080_handle_t hdc_handle){
+  if(hdc_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!hdc1080_lock(hdc_handle)){ return ESP_ERR_TIMEOUT; }
+  esp_err_t err_ck = HDC1080_CONVERTING;
+  if(hdc_handle->awaiting_conversion){
+    HDC1080_COUNT(hdc_handle, converting, 1);
+  }else{
+    err_ck = hdc1080_recover_device(hdc_handle);
+  }
+  hdc1080_unlock(hdc_handle);
+  return err_ck;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static esp_err_t hdc1080_verify_identity(hdc1080_handle_t hdc)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Make sure a TI HDC1080 answers at the configured address and
+ * read its serial when the instance keeps a warm start cache
+ * @param hdc -> the instance being configured
+ * @return ESP_OK on success, HDC1080_ERR_ID when the IDs do not match,
+ *         otherwise the read error
+ */
+static esp_err_t hdc1080_verify_identity(hdc1080_handle_t hdc){
+  unsigned char hdc_buff[2] = {0};
+  // GET MANUFACTURER ID AND ENSURE A MATCH
+  esp_err_t err_ck = check_hdc1080_error(hdc, read_hdc100_data(hdc, HDC1080_MANUFACTURER_ID_REG, hdc_buff, 2));
+  if(err_ck != ESP_OK){ return err_ck; }
+  if((unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]) != HDC1080_MANUFACTURER_ID){
+    // NOT A TI CHIP
+    ESP_LOGE("HDC1080", "EXPECTED TI ID 0x%04X BUT GOT 0x%04X", HDC1080_MANUFACTURER_ID, (unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]));
+    return HDC1080_ERR_ID;
+  }
+  // GET THE DEVICE ID AND MAKE SURE IT'S AN HDC1080
+  err_ck = check_hdc1080_error(hdc, read_hdc100_data(hdc, HDC1080_DEVICE_ID_REG, hdc_buff, 2));
+  if(err_ck != ESP_OK){ return err_ck; }
+  if((unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]) != HDC1080_DEVICE_ID){
+    // NOT AND HDC1080
+    ESP_LOGE("HDC1080", "EXPECTED DEVICE ID 0x%04X BUT GOT 0x%04X", HDC1080_DEVICE_ID, (unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]));
+    return HDC1080_ERR_ID;
+  }
+  // THE SERIAL IS ONLY WORTH THE THREE READS WHEN IT GETS CACHED
+  if(hdc->settings.warm_start != NULL){ err_ck = hdc1080_read_serial_id(hdc); }
+  return err_ck;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static esp_err_t hdc1080_read_serial_id(hdc1080_handle_t hdc)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Read the 41 bit serial into serial_id
+ * @param hdc -> the instance to read, the bus must be free
+ * @return ESP_OK on success
+ */
+static esp_err_t hdc1080_read_serial_id(hdc1080_handle_t hdc){
+  static const unsigned char serial_regs[3] = {HDC1080_SERIALID2_REG, HDC1080_SERIALID1_REG, HDC1080_SERIALID0_REG};
+  unsigned short serial_words[3] = {0};
+  unsigned char hdc_buff[2] = {0};
+  for(int i = 0; i < 3; i++){
+    esp_err_t err_ck = check_hdc1080_error(hdc, read_hdc100_data(hdc, serial_regs[i], hdc_buff, 2));
+    if(err_ck != ESP_OK){ return err_ck; }
+    serial_words[i] = (unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]);
+  }
+  // SERIALID2 HOLDS BITS 40-25, SERIALID1 BITS 24-9 AND THE TOP 9 BITS OF SERIALID0 BITS 8-0
+  hdc->serial_id = ((uint64_t)serial_words[0] << 25) | ((uint64_t)serial_words[1] << 9) | (serial_words[2] >> 7);
+  hdc->serial_known = true;
+  return ESP_OK;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static esp_err_t hdc1080_write_configuration(hdc1080_handle_t hdc, hdc1080_config_t hdc_cfg, bool check_first)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Write the config register
+ * @param hdc -> the instance to write, the bus must be free
+ * @param hdc_cfg -> the register configuration
+ * @param check_first -> read the register first and skip the write
+ *        when it already matches
+ * @return ESP_OK on success
+ */
+static esp_err_t hdc1080_write_configuration(hdc1080_handle_t hdc, hdc1080_config_t hdc_cfg, bool check_first){
+  unsigned char hdc_buff[2] = {0};
+  unsigned short cfg_s = (hdc_cfg.config_register << 8);
+  if(check_first){
+    // GET THE CURRENT CONFIGURATION AND IF IT DOESN'T MATCH, UPDATE IT
+    esp_err_t err_ck = check_hdc1080_error(hdc, read_hdc100_data(hdc, HDC1080_CONFIG_REG, hdc_buff, 2));
+    if(err_ck != ESP_OK){ return err_ck; }
+    ESP_LOGD("HDC1080", "CURRENT CONFIGURATION 0x%04X", (unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]));
+    if((unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]) == cfg_s){ return ESP_OK; }
+    ESP_LOGD("HDC1080", "UPDATING CONFIGURATION FROM 0x%04X TO 0x%04X", (unsigned short)((hdc_buff[0] << 8) | hdc_buff[1]), cfg_s);
+  }
+  hdc_buff[0] = hdc_cfg.config_register;
+  hdc_buff[1] = 0;
+  return check_hdc1080_error(hdc, write_hdc100_data(hdc, HDC1080_CONFIG_REG, hdc_buff, 2));
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static bool hdc1080_warm_start_valid(const hdc1080_settings_t * settings)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Tell whether the warm start cache can stand in for the bring up checks
+ * @param settings -> the settings being configured
+ * @return true for a filled cache of the same sensor after a deep sleep wake
+ */
+static bool hdc1080_warm_start_valid(const hdc1080_settings_t * settings){
+  const hdc1080_warm_start_t * warm_start = settings->warm_start;
+  if(warm_start == NULL || warm_start->magic != HDC1080_WARM_START_MAGIC){ return false; }
+  if(warm_start->checksum != hdc1080_warm_start_checksum(warm_start)){ return false; }
+  if(warm_start->i2c_address != settings->i2c_address || warm_start->i2c_port_number != settings->i2c_port_number){ return false; }
+#if !CONFIG_IDF_TARGET_LINUX
+  // AFTER ANY OTHER RESET THE SENSOR MAY HAVE BEEN POWER CYCLED OR SWAPPED
+  if(esp_reset_reason() != ESP_RST_DEEPSLEEP){ return false; }
+#endif
+  return true;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static void hdc1080_store_warm_start(hdc1080_handle_t hdc)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Bring the warm start cache in line with the instance
+ * @param hdc -> the instance, its identity must be verified
+ */
+static void hdc1080_store_warm_start(hdc1080_handle_t hdc){
+  hdc1080_warm_start_t * warm_start = hdc->settings.warm_start;
+  if(warm_start == NULL || !hdc->serial_known){ return; }
+  memset(warm_start, 0, sizeof(hdc1080_warm_start_t));
+  warm_start->magic = HDC1080_WARM_START_MAGIC;
+  warm_start->i2c_address = hdc->settings.i2c_address;
+  warm_start->i2c_port_number = hdc->settings.i2c_port_number;
+  warm_start->config_register = hdc->config.config_register;
+  warm_start->serial_id = hdc->serial_id;
+  warm_start->checksum = hdc1080_warm_start_checksum(warm_start);
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static uint32_t hdc1080_warm_start_checksum(const hdc1080_warm_start_t * warm_start)
+ * --------------------------------------------------------------------------------------------------
+ * @brief FNV-1a over every byte in front of the checksum
+ * @param warm_start -> the cache to sum
+ * @return the checksum
+ */
+static uint32_t hdc1080_warm_start_checksum(const hdc1080_warm_start_t * warm_start){
+  const unsigned char * bytes = (const unsigned char *)warm_start;
+  uint32_t hash = 2166136261u;
+  for(size_t i = 0; i < offsetof(hdc1080_warm_start_t, checksum); i++){
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static esp_err_t hdc1080_health_gate(hdc1080_handle_t hdc, bool recover)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Decide whether an operation may use the bus, run before
+ * anything that starts bus traffic on an idle instance
+ * @param hdc -> the instance, its lock must be held
+ * @param recover -> true when the caller may block for a recovery,
+ *        false in the esp_timer task where a sensor that is down
+ *        keeps failing fast until a task gets to recover it
+ * @return ESP_OK to go ahead, HDC1080_ERR_DOWN while backing off,
+ *         otherwise the failed recovery of a sensor that is down
+ */
+static esp_err_t hdc1080_health_gate(hdc1080_handle_t hdc, bool recover){
+  if(hdc->health_failures == 0){ return ESP_OK; }
+  if(esp_timer_get_time() < hdc->health_retry_at || (hdc->health_down && !recover)){
+    HDC1080_COUNT(hdc, fast_failed, 1);
+    return HDC1080_ERR_DOWN;
+  }
+  // THE BACKOFF IS OVER, A SENSOR THAT ONLY FAILED A FEW TIMES GETS THIS
+  // CALL AS ITS RETRY, ONE THAT IS DOWN IS RECOVERED FIRST
+  if(hdc->health_down){ return hdc1080_recover_device(hdc); }
+  return ESP_OK;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static void hdc1080_health_record(hdc1080_handle_t hdc, esp_err_t bus_err)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Track the result of a bus operation
+ * @param hdc -> the instance that owns the bus
+ * @param bus_err -> the result, a NACK or a timeout is a failure and
+ *        ESP_OK clears them, anything else says nothing about the sensor
+ */
+static void hdc1080_health_record(hdc1080_handle_t hdc, esp_err_t bus_err){
+  if(hdc->settings.health.failure_threshold == 0){ return; }
+  if(bus_err == ESP_OK){
+    hdc->health_failures = 0;
+    hdc->health_down = false;
+    hdc->health_retry_at = 0;
+    return;
+  }
+  if(bus_err != ESP_FAIL && bus_err != ESP_ERR_TIMEOUT){ return; }
+  if(hdc->health_failures < UINT32_MAX){ hdc->health_failures++; }
+  hdc->health_retry_at = esp_timer_get_time() + hdc1080_health_backoff(hdc);
+  if(!hdc->health_down && hdc->health_failures >= hdc->settings.health.failure_threshold){
+    hdc->health_down = true;
+    ESP_LOGW("HDC1080", "0x%02X ON PORT %u DOWN AFTER %u FAILURES", hdc->settings.i2c_address, hdc->settings.i2c_port_number, hdc->health_failures);
+  }
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static int64_t hdc1080_health_backoff(hdc1080_handle_t hdc)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Backoff for the current number of failures in a row
+ * @param hdc -> the instance
+ * @return backoff_min doubled for every failure after the first,
+ *         capped at backoff_max, in microseconds
+ */
+static int64_t hdc1080_health_backoff(hdc1080_handle_t hdc){
+  int64_t backoff = hdc->settings.health.backoff_min;
+  int64_t backoff_max = hdc->settings.health.backoff_max;
+  if(backoff == 0){ backoff = HDC1080_BACKOFF_MIN; }
+  if(backoff_max == 0){ backoff_max = HDC1080_BACKOFF_MAX; }
+  for(unsigned int i = 1; i < hdc->health_failures && backoff < backoff_max; i++){ backoff *= 2; }
+  return (backoff < backoff_max) ? backoff : backoff_max;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static esp_err_t hdc1080_recover_device(hdc1080_handle_t hdc)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Clear the bus, soft reset the HDC1080 through the
+ * software_reset bit and write the config back
+ * @param hdc -> the instance, its lock must be held and no
+ *        conversion may be in flight
+ * @return ESP_OK when the config reads back, otherwise the step
+ *         that failed. A failed recovery keeps the sensor down
+ *         with a longer backoff
+ * @note Blocks for HDC1080_RESET_TIME
+ */
+static esp_err_t hdc1080_recover_device(hdc1080_handle_t hdc){
+  unsigned int failures = hdc->health_failures;
+  ESP_LOGW("HDC1080", "RECOVERING 0x%02X ON PORT %u", hdc->settings.i2c_address, hdc->settings.i2c_port_number);
+  // FREE THE BUS FIRST IN CASE A DEVICE IS HOLDING SDA LOW, THE BUILT IN BACKEND ONLY RESETS THE FIFOS
+  esp_err_t err_ck = ESP_OK;
+  if(hdc->settings.bus.transfer == NULL){
+    err_ck = hdc1080_i2c_driver_clear((void *)(intptr_t)hdc->settings.i2c_port_number);
+  }else if(hdc->settings.bus.clear != NULL){
+    err_ck = hdc->settings.bus.clear(hdc->settings.bus.bus_ctx);
+  }
+  if(err_ck == ESP_OK){
+    hdc1080_config_t reset_cfg = { .software_reset = 1 };
+    err_ck = hdc1080_write_configuration(hdc, reset_cfg, false);
+  }
+  if(err_ck == ESP_OK){
+    // THE HDC1080 NACKS EVERYTHING UNTIL THE RESET IS DONE
+    vTaskDelay(pdMS_TO_TICKS(HDC1080_RESET_TIME / 1000) + 1);
+    // THE RESET PUT THE DEFAULTS BACK, READING FIRST ALSO PROVES IT ANSWERS
+    err_ck = hdc1080_write_configuration(hdc, hdc->config, true);
+  }
+  if(err_ck == ESP_OK){
+    HDC1080_COUNT(hdc, recoveries, 1);
+    ESP_LOGI("HDC1080", "0x%02X ON PORT %u RECOVERED", hdc->settings.i2c_address, hdc->settings.i2c_port_number);
+    return ESP_OK;
+  }
+  HDC1080_COUNT(hdc, recoveries_failed, 1);
+  if(hdc->settings.health.failure_threshold > 0){
+    // A STEP THAT WENT THROUGH HALF WAY MUST NOT CLOSE THE BREAKER, COUNT THE WHOLE RUN AS ONE FAILURE
+    hdc->health_failures = failures;
+    hdc->health_down = true;
+    hdc1080_health_record(hdc, ESP_FAIL);
+  }
+  return err_ck;
+}
+
 /* --------------------------------------------------------------------------------------------------
- * @name static esp_err_t write_hdc100_data(unsigned char i2c_register, unsigned char * write_buff, size_t write_len)
+ * @name static esp_err_t write_hdc100_data(hdc1080_handle_t hdc, unsigned char i2c_register, unsigned char * write_buff, size_t write_len)
  * --------------------------------------------------------------------------------------------------
  * @brief Write to the i2c bus
+ * @param hdc -> the instance to write to
  * @param i2c_register -> register to write to
  * @param write_buff -> pointer to the buffer with the data
- * @param write_len -> length of the write
+ * @param write_len -> length of the write, at most HDC1080_MAX_WRITE_LEN
  * @return ESP_OK on success* 
  */
-static esp_err_t write_hdc100_data(unsigned char i2c_register, unsigned char * write_buff, size_t write_len){
-  /* CHANGE TO THE CORRECT REGISTER BEFORE THE READ */
-  i2c_cmd_handle_t cmdlnk = i2c_cmd_link_create();
-  check_hdc1080_error(i2c_master_start(cmdlnk));
-  check_hdc1080_error(i2c_master_write_byte(cmdlnk, (hdc1080_set.i2c_address << 1) | I2C_MASTER_WRITE, true));
-  check_hdc1080_error(i2c_master_write_byte(cmdlnk, i2c_register, true));
-  check_hdc1080_error(i2c_master_write(cmdlnk, write_buff, write_len, I2C_MASTER_LAST_NACK));
-  check_hdc1080_error(i2c_master_stop(cmdlnk));
-  esp_err_t err_ck = check_hdc1080_error(i2c_master_cmd_begin(hdc1080_set.i2c_port_number, cmdlnk, hdc1080_set.timeout_length));
-  i2c_cmd_link_delete(cmdlnk);
-  return err_ck;
+static esp_err_t write_hdc100_data(hdc1080_handle_t hdc, unsigned char i2c_register, unsigned char * write_buff, size_t write_len){
+  if(write_len > HDC1080_MAX_WRITE_LEN){ return ESP_ERR_INVALID_SIZE; }
+  /* THE REGISTER POINTER AND THE DATA GO OUT IN ONE WRITE */
+  unsigned char reg_buff[HDC1080_MAX_WRITE_LEN + 1];
+  reg_buff[0] = i2c_register;
+  memcpy(&reg_buff[1], write_buff, write_len);
+  return hdc1080_i2c_transfer(hdc, reg_buff, write_len + 1, NULL, 0);
 }
 
 /* --------------------------------------------------------------------------------------------------
- * @name static esp_err_t read_hdc100_data(unsigned char i2c_register, unsigned char * read_buff, size_t read_len)
+ * @name static esp_err_t read_hdc100_data(hdc1080_handle_t hdc, unsigned char i2c_register, unsigned char * read_buff, size_t read_len)
  * --------------------------------------------------------------------------------------------------
  * @brief Read from the i2c bus
+ * @param hdc -> the instance to read from
  * @param i2c_register -> register to read from
  * @param read_buff -> pointer to the buffer where the data will be stored
  * @param read_len -> length of the read
  * @return ESP_OK on success* 
+ * @note Not for the measurement registers, those need the conversion
+ *       wait between setting the pointer and reading
  */
-static esp_err_t read_hdc100_data(unsigned char i2c_register, unsigned char * read_buff, size_t read_len){
-  /* CHANGE TO THE CORRECT REGISTER BEFORE THE READ */
-  i2c_cmd_handle_t cmdlnk = i2c_cmd_link_create();
-  check_hdc1080_error(i2c_master_start(cmdlnk));
-  check_hdc1080_error(i2c_master_write_byte(cmdlnk, (hdc1080_set.i2c_address << 1) | I2C_MASTER_WRITE, true));
-  check_hdc1080_error(i2c_master_write_byte(cmdlnk, i2c_register, true));
-  check_hdc1080_error(i2c_master_stop(cmdlnk));
-  esp_err_t err_ck = check_hdc1080_error(i2c_master_cmd_begin(hdc1080_set.i2c_port_number, cmdlnk, hdc1080_set.timeout_length));
-  i2c_cmd_link_delete(cmdlnk);
-  if(err_ck != ESP_OK){ return err_ck; }
-  /* BEGIN THE READ */
-  cmdlnk = i2c_cmd_link_create();
-  check_hdc1080_error(i2c_master_start(cmdlnk));
-  check_hdc1080_error(i2c_master_write_byte(cmdlnk, (hdc1080_set.i2c_address << 1) | I2C_MASTER_READ, true));
-  check_hdc1080_error(i2c_master_read(cmdlnk, read_buff, read_len, I2C_MASTER_LAST_NACK));
-  check_hdc1080_error(i2c_master_stop(cmdlnk));
-  err_ck = check_hdc1080_error(i2c_master_cmd_begin(hdc1080_set.i2c_port_number, cmdlnk, hdc1080_set.timeout_length));
-  i2c_cmd_link_delete(cmdlnk);
+static esp_err_t read_hdc100_data(hdc1080_handle_t hdc, unsigned char i2c_register, unsigned char * read_buff, size_t read_len){
+  /* SET THE REGISTER POINTER AND READ BACK WITH A REPEATED START */
+  return hdc1080_i2c_transfer(hdc, &i2c_register, 1, read_buff, read_len);
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static esp_err_t hdc1080_i2c_transfer(hdc1080_handle_t hdc, const unsigned char * write_buff, size_t write_len, unsigned char * read_buff, size_t read_len)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Run a single i2c transaction on the configured bus backend,
+ * the esp-idf i2c driver unless hdc1080_settings_t.bus says otherwise.
+ * When both a write and a read are given they are joined with a
+ * repeated start
+ * @param hdc -> the instance to talk to
+ * @param write_buff -> bytes to write, may be NULL when write_len is 0
+ * @param write_len -> number of bytes to write
+ * @param read_buff -> where to store the read, may be NULL when read_len is 0
+ * @param read_len -> number of bytes to read
+ * @return ESP_OK on success, ESP_FAIL when the HDC1080 NACKs
+ */
+static esp_err_t hdc1080_i2c_transfer(hdc1080_handle_t hdc, const unsigned char * write_buff, size_t write_len, unsigned char * read_buff, size_t read_len){
+  esp_err_t err_ck = ESP_OK;
+  int64_t started = esp_timer_get_time();
+  if(hdc->settings.bus.transfer != NULL){
+    err_ck = hdc->settings.bus.transfer(hdc->settings.bus.bus_ctx, hdc->settings.i2c_address, write_buff, write_len, read_buff, read_len, hdc->settings.timeout_length);
+  }else{
+    err_ck = hdc1080_i2c_driver_transfer((void *)(intptr_t)hdc->settings.i2c_port_number, hdc->settings.i2c_address, write_buff, write_len, read_buff, read_len, hdc->settings.timeout_length);
+  }
+  // TIME BLOCKED ON THE BUS, i2c_master_cmd_begin OR THE BACKEND
+  HDC1080_COUNT(hdc, bus_time, (unsigned int)(esp_timer_get_time() - started));
+  HDC1080_COUNT(hdc, bus_transactions, 1);
+  return err_ck;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name void hdc1080_bus_i2c_driver(unsigned char i2c_port_number, hdc1080_bus_t * bus)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Fill a bus backend that runs on the esp-idf i2c driver, for
+ * code that talks to other devices on the same bus, like a mux
+ * @param i2c_port_number -> the configured i2c port
+ * @param bus -> filled with the backend
+ */
+void hdc1080_bus_i2c_driver(unsigned char i2c_port_number, hdc1080_bus_t * bus){
+  bus->transfer = hdc1080_i2c_driver_transfer;
+  bus->bus_ctx = (void *)(intptr_t)i2c_port_number;
+  bus->clear = hdc1080_i2c_driver_clear;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static esp_err_t hdc1080_i2c_driver_transfer(void * bus_ctx, unsigned char i2c_address, const unsigned char * write_buff, size_t write_len, unsigned char * read_buff, size_t read_len, TickType_t timeout)
+ * --------------------------------------------------------------------------------------------------
+ * @brief The built in bus backend, runs the transaction on the esp-idf
+ * i2c driver without touching the heap. The command link lives on the stack
+ * @param bus_ctx -> the i2c port number
+ * @return ESP_OK on success, ESP_FAIL when the HDC1080 NACKs,
+ *         ESP_ERR_NOT_SUPPORTED on a linux host build
+ */
+static esp_err_t hdc1080_i2c_driver_transfer(void * bus_ctx, unsigned char i2c_address, const unsigned char * write_buff, size_t write_len, unsigned char * read_buff, size_t read_len, TickType_t timeout){
+#if CONFIG_IDF_TARGET_LINUX
+  /* THERE IS NO i2c DRIVER ON A HOST BUILD, USE A BUS BACKEND SUCH AS hdc1080_sim */
+  return ESP_ERR_NOT_SUPPORTED;
+#else
+  unsigned char link_buff[HDC1080_CMD_LINK_SIZE];
+  i2c_cmd_handle_t cmdlnk = i2c_cmd_link_create_static(link_buff, sizeof(link_buff));
+  if(cmdlnk == NULL){ return ESP_ERR_NO_MEM; }
+  esp_err_t err_ck = ESP_OK;
+  if(write_len > 0){
+    if(err_ck == ESP_OK){ err_ck = i2c_master_start(cmdlnk); }
+    if(err_ck == ESP_OK){ err_ck = i2c_master_write_byte(cmdlnk, (i2c_address << 1) | I2C_MASTER_WRITE, true); }
+    if(err_ck == ESP_OK){ err_ck = i2c_master_write(cmdlnk, write_buff, write_len, true); }
+  }
+  if(read_len > 0){
+    if(err_ck == ESP_OK){ err_ck = i2c_master_start(cmdlnk); }
+    if(err_ck == ESP_OK){ err_ck = i2c_master_write_byte(cmdlnk, (i2c_address << 1) | I2C_MASTER_READ, true); }
+    if(err_ck == ESP_OK){ err_ck = i2c_master_read(cmdlnk, read_buff, read_len, I2C_MASTER_LAST_NACK); }
+  }
+  if(err_ck == ESP_OK){ err_ck = i2c_master_stop(cmdlnk); }
+  if(err_ck == ESP_OK){ err_ck = i2c_master_cmd_begin((i2c_port_t)(intptr_t)bus_ctx, cmdlnk, timeout); }
+  i2c_cmd_link_delete_static(cmdlnk);
+  return err_ck;
+#endif
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static esp_err_t hdc1080_i2c_driver_clear(void * bus_ctx)
+ * --------------------------------------------------------------------------------------------------
+ * @brief The bus clear of the built in backend. It only resets the
+ * TX and RX FIFOs of the port, it does not toggle SCL or send a STOP.
+ * The pins and the bus config belong to the application, so freeing a
+ * device that holds SDA low is left to the timeout handling of the
+ * esp-idf i2c driver or to a bus backend with its own clear
+ * @param bus_ctx -> the i2c port number
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED on a linux host build
+ */
+static esp_err_t hdc1080_i2c_driver_clear(void * bus_ctx){
+#if CONFIG_IDF_TARGET_LINUX
+  return ESP_ERR_NOT_SUPPORTED;
+#else
+  esp_err_t err_ck = i2c_reset_tx_fifo((i2c_port_t)(intptr_t)bus_ctx);
+  if(err_ck == ESP_OK){ err_ck = i2c_reset_rx_fifo((i2c_port_t)(intptr_t)bus_ctx); }
   return err_ck;
+#endif
+}
+
+/* --------------------------------------------------------------
+ * @name static bool hdc1080_lock(hdc1080_handle_t hdc)
+ * --------------------------------------------------------------
+ * @brief Take the instance lock
+ * @param hdc -> the instance to lock
+ * @return true when the lock was taken
+ */
+static bool hdc1080_lock(hdc1080_handle_t hdc){
+  return (xSemaphoreTake(hdc->lock, hdc->settings.timeout_length) == pdTRUE);
 }
 
 /* --------------------------------------------------------------
- * @name static esp_err_t check_hdc1080_error(esp_err_t hdc_err)
+ * @name static void hdc1080_unlock(hdc1080_handle_t hdc)
  * --------------------------------------------------------------
- * @brief Check for esp errors and print them
+ * @brief Give back the instance lock
+ * @param hdc -> the instance to unlock
+ */
+static void hdc1080_unlock(hdc1080_handle_t hdc){
+  xSemaphoreGive(hdc->lock);
+}
+
+/* --------------------------------------------------------------
+ * @name static esp_err_t check_hdc1080_error(hdc1080_handle_t hdc, esp_err_t hdc_err)
+ * --------------------------------------------------------------
+ * @brief Check for esp errors, count them by class and print them
+ * @param hdc -> the instance the error happened on
  * @param hdc_err -> The returned error from the check
  * @return ESP_OK on success, original error on fail
- * @note Any special error handling can be put in here
+ * @note Only for the results of bus operations, they also feed
+ *       the health tracking
  */
-static esp_err_t check_hdc1080_error(esp_err_t hdc_err){
+static esp_err_t check_hdc1080_error(hdc1080_handle_t hdc, esp_err_t hdc_err){
+  hdc1080_health_record(hdc, hdc_err);
   if(hdc_err == ESP_OK){ return ESP_OK; }
+  switch(hdc_err){
+    case ESP_FAIL: HDC1080_COUNT(hdc, errors_nack, 1); break;
+    case ESP_ERR_TIMEOUT: HDC1080_COUNT(hdc, errors_timeout, 1); break;
+    case ESP_ERR_INVALID_STATE: HDC1080_COUNT(hdc, errors_invalid_state, 1); break;
+    default: HDC1080_COUNT(hdc, errors_other, 1); break;
+  }
   ESP_LOGE("HDC1080", "ERROR HAS OCCURED: %s", esp_err_to_name(hdc_err));
   return hdc_err;
-}
\ No newline at end of file
+}
@@ -0,0 +1,178 @@
+/*
+ * ESP32 HDC1080 COMPONENT DRIVER LIBRARY
+ * Copyright 2023 Open grStat
+ *
+ * SPDX-FileCopyrightText: 2023 Open grStat https://github.com/grstat
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: Created by Adrian Borchardt
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ */
+#include <string.h>
+#include "hdc1080_filter.h"
+
+#define HDC1080_EMA_FRACTION  8   /* FRACTIONAL BITS KEPT IN THE EMA */
+
+static unsigned short hdc1080_filter_median(unsigned short * codes, unsigned int count);
+static hdc1080_raw_readings_t hdc1080_filter_decimate(const hdc1080_filter_t * filter, hdc1080_filter_state_t * state);
+static bool hdc1080_filter_moved(unsigned int from, unsigned int to, unsigned int deadband);
+
+/* -------------------------------------------------------------
+ * @name bool hdc1080_filter_valid(const hdc1080_filter_t * filter)
+ * -------------------------------------------------------------
+ * @brief Check the filter settings are in range
+ * @param filter -> the settings to check
+ * @return true when they can be used
+ */
+bool hdc1080_filter_valid(const hdc1080_filter_t * filter){
+  if(filter == NULL){ return false; }
+  if(filter->oversample > HDC1080_FILTER_MAX_OVERSAMPLE){ return false; }
+  if(filter->decimation > HDC1080_DECIMATE_MEDIAN){ return false; }
+  if(filter->ema_shift > HDC1080_FILTER_MAX_EMA_SHIFT){ return false; }
+  return true;
+}
+
+/* -------------------------------------------------------------
+ * @name void hdc1080_filter_reset(hdc1080_filter_state_t * state)
+ * -------------------------------------------------------------
+ * @brief Forget everything the filter has seen, the next
+ * conversion starts a new window, seeds the EMA and is passed on
+ * @param state -> the state to clear
+ */
+void hdc1080_filter_reset(hdc1080_filter_state_t * state){
+  memset(state, 0, sizeof(hdc1080_filter_state_t));
+}
+
+/* -------------------------------------------------------------
+ * @name unsigned char hdc1080_filter_push(const hdc1080_filter_t * filter, hdc1080_filter_state_t * state, unsigned char channel, hdc1080_raw_readings_t * raw, int64_t now)
+ * -------------------------------------------------------------
+ * @brief Run one successful conversion through the filter
+ * @param filter -> the filter settings
+ * @param state -> the filter state of the sensor
+ * @param channel -> the HDC1080_CHANNEL_* that was measured, the
+ *        deadband ignores a channel that was not measured
+ * @param raw -> the codes read, replaced with the filtered codes
+ *        when HDC1080_FILTER_PASS is returned
+ * @param now -> esp_timer time of the conversion
+ * @return HDC1080_FILTER_PASS, HDC1080_FILTER_DECIMATED or
+ *         HDC1080_FILTER_SUPPRESSED
+ * @note Failed conversions must not be pushed, they say nothing
+ *       about the value
+ */
+unsigned char hdc1080_filter_push(const hdc1080_filter_t * filter, hdc1080_filter_state_t * state, unsigned char channel, hdc1080_raw_readings_t * raw, int64_t now){
+  hdc1080_raw_readings_t result = *raw;
+  if(filter->oversample > 1){
+    state->window[state->window_count++] = *raw;
+    if(state->window_count < filter->oversample){ return HDC1080_FILTER_DECIMATED; }
+    result = hdc1080_filter_decimate(filter, state);
+    state->window_count = 0;
+  }
+  if(filter->ema_shift > 0){
+    int32_t temperature = (int32_t)result.temperature << HDC1080_EMA_FRACTION;
+    int32_t humidity = (int32_t)result.humidity << HDC1080_EMA_FRACTION;
+    if(!state->ema_primed){
+      // SEED WITH THE FIRST CODE SO THE OUTPUT DOES NOT RAMP UP FROM 0
+      state->ema_temperature = temperature;
+      state->ema_humidity = humidity;
+      state->ema_primed = true;
+    }else{
+      state->ema_temperature += (temperature - state->ema_temperature) >> filter->ema_shift;
+      state->ema_humidity += (humidity - state->ema_humidity) >> filter->ema_shift;
+    }
+    result.temperature = (unsigned short)((state->ema_temperature + (1 << (HDC1080_EMA_FRACTION - 1))) >> HDC1080_EMA_FRACTION);
+    result.humidity = (unsigned short)((state->ema_humidity + (1 << (HDC1080_EMA_FRACTION - 1))) >> HDC1080_EMA_FRACTION);
+  }
+  // THE DEADBAND IS IN CENTI UNITS SO IT READS THE SAME AT EVERY RESOLUTION
+  hdc1080_fixed_readings_t fixed = {
+    .temperature = hdc1080_temperature_centi(result.temperature),
+    .humidity = hdc1080_humidity_centi(result.humidity)
+  };
+  if(state->reported && (filter->temperature_deadband > 0 || filter->humidity_deadband > 0)){
+    bool changed = false;
+    if(channel != HDC1080_CHANNEL_HUMIDITY){
+      changed |= hdc1080_filter_moved((unsigned int)(fixed.temperature + 4000), (unsigned int)(state->last_reported.temperature + 4000), filter->temperature_deadband);
+    }
+    if(channel != HDC1080_CHANNEL_TEMPERATURE){
+      changed |= hdc1080_filter_moved(fixed.humidity, state->last_reported.humidity, filter->humidity_deadband);
+    }
+    bool silent_too_long = (filter->max_silence > 0 && (now - state->last_reported_at) >= (int64_t)filter->max_silence);
+    if(!changed && !silent_too_long){ return HDC1080_FILTER_SUPPRESSED; }
+  }
+  state->reported = true;
+  state->last_reported = fixed;
+  state->last_reported_at = now;
+  *raw = result;
+  return HDC1080_FILTER_PASS;
+}
+
+/* -------------------------------------------------------------
+ * @name static hdc1080_raw_readings_t hdc1080_filter_decimate(const hdc1080_filter_t * filter, hdc1080_filter_state_t * state)
+ * -------------------------------------------------------------
+ * @brief Reduce the collected window to one pair of codes
+ * @param filter -> the filter settings
+ * @param state -> the state holding a full window
+ * @return the rounded mean or the median of each channel
+ */
+static hdc1080_raw_readings_t hdc1080_filter_decimate(const hdc1080_filter_t * filter, hdc1080_filter_state_t * state){
+  hdc1080_raw_readings_t result = {0};
+  unsigned int count = state->window_count;
+  if(filter->decimation == HDC1080_DECIMATE_MEDIAN){
+    unsigned short temperature[HDC1080_FILTER_MAX_OVERSAMPLE];
+    unsigned short humidity[HDC1080_FILTER_MAX_OVERSAMPLE];
+    for(unsigned int i = 0; i < count; i++){
+      temperature[i] = state->window[i].temperature;
+      humidity[i] = state->window[i].humidity;
+    }
+    result.temperature = hdc1080_filter_median(temperature, count);
+    result.humidity = hdc1080_filter_median(humidity, count);
+    return result;
+  }
+  uint32_t temperature = 0;
+  uint32_t humidity = 0;
+  for(unsigned int i = 0; i < count; i++){
+    temperature += state->window[i].temperature;
+    humidity += state->window[i].humidity;
+  }
+  result.temperature = (unsigned short)((temperature + (count / 2)) / count);
+  result.humidity = (unsigned short)((humidity + (count / 2)) / count);
+  return result;
+}
+
+/* -------------------------------------------------------------
+ * @name static unsigned short hdc1080_filter_median(unsigned short * codes, unsigned int count)
+ * -------------------------------------------------------------
+ * @brief Median of a short run of codes, an insertion sort is
+ * plenty for HDC1080_FILTER_MAX_OVERSAMPLE entries
+ * @param codes -> the codes, sorted in place
+ * @param count -> number of codes, at least 1
+ * @return the middle code, the rounded mean of the two middle
+ *         codes for an even count
+ */
+static unsigned short hdc1080_filter_median(unsigned short * codes, unsigned int count){
+  for(unsigned int i = 1; i < count; i++){
+    unsigned short code = codes[i];
+    unsigned int j = i;
+    while(j > 0 && codes[j - 1] > code){
+      codes[j] = codes[j - 1];
+      j--;
+    }
+    codes[j] = code;
+  }
+  if(count & 1){ return codes[count / 2]; }
+  return (unsigned short)(((uint32_t)codes[(count / 2) - 1] + codes[count / 2] + 1) / 2);
+}
+
+/* -------------------------------------------------------------
+ * @name static bool hdc1080_filter_moved(unsigned int from, unsigned int to, unsigned int deadband)
+ * -------------------------------------------------------------
+ * @brief Tell whether a value left the deadband
+ * @param from -> the new value
+ * @param to -> the value last passed on
+ * @param deadband -> the deadband, 0 never triggers
+ * @return true when the values differ by at least deadband
+ */
+static bool hdc1080_filter_moved(unsigned int from, unsigned int to, unsigned int deadband){
+  if(deadband == 0){ return false; }
+  unsigned int delta = (from > to) ? (from - to) : (to - from);
+  return delta >= deadband;
+}
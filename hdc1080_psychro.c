@@ -0,0 +1,201 @@
+/*
+ * ESP32 HDC1080 COMPONENT DRIVER LIBRARY
+ * Copyright 2023 Open grStat
+ *
+ * SPDX-FileCopyrightText: 2023 Open grStat https://github.com/grstat
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: Created by Adrian Borchardt
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ */
+#include "hdc1080_psychro.h"
+
+#define HDC1080_LOG2E             1.44269504f   /* 1 / ln(2) */
+#define HDC1080_SVP_TABLE_MIN     (-40)         /* FIRST TABLE ENTRY IN °C */
+#define HDC1080_SVP_TABLE_LEN     166           /* ONE ENTRY PER °C, -40°C TO 125°C */
+
+/* SATURATION VAPOR PRESSURE IN CENTI-PASCALS FOR EVERY WHOLE °C FROM
+ * -40°C TO 125°C, GENERATED FROM THE REFERENCE FORMULA AND ROUNDED */
+static const uint32_t hdc1080_svp_table[HDC1080_SVP_TABLE_LEN] = {
+  1842, 2046, 2269, 2515, 2784, 3078, 3401, 3753,
+  4139, 4559, 5018, 5517, 6061, 6652, 7295, 7993,
+  8750, 9571, 10460, 11422, 12462, 13587, 14801, 16111,
+  17524, 19046, 20685, 22449, 24345, 26383, 28571, 30919,
+  33436, 36134, 39024, 42117, 45425, 48961, 52740, 56773,
+  61078, 65669, 70561, 75774, 81323, 87227, 93506, 100181,
+  107271, 114800, 122789, 131264, 140248, 149767, 159850, 170523,
+  181816, 193759, 206383, 219722, 233809, 248680, 264371, 280919,
+  298365, 316749, 336113, 356500, 377956, 400528, 424263, 449213,
+  475427, 502961, 531868, 562206, 594032, 627409, 662398, 699064,
+  737472, 777692, 819793, 863849, 909933, 958123, 1008498, 1061139,
+  1116129, 1173555, 1233504, 1296068, 1361339, 1429414, 1500390, 1574368,
+  1651451, 1731746, 1815361, 1902408, 1993001, 2087256, 2185294, 2287238,
+  2393213, 2503348, 2617775, 2736628, 2860045, 2988167, 3121139, 3259107,
+  3402222, 3550638, 3704512, 3864004, 4029279, 4200503, 4377848, 4561487,
+  4751599, 4948364, 5151968, 5362599, 5580449, 5805714, 6038594, 6279293,
+  6528016, 6784976, 7050387, 7324468, 7607441, 7899534, 8200975, 8512001,
+  8832850, 9163764, 9504989, 9856778, 10219384, 10593066, 10978089, 11374719,
+  11783228, 12203891, 12636990, 13082808, 13541635, 14013763, 14499490, 14999118,
+  15512952, 16041304, 16584489, 17142825, 17716637, 18306254, 18912008, 19534236,
+  20173280, 20829487, 21503208, 22194798, 22904617, 23633029
+};
+
+static float hdc1080_exp2f(float x);
+
+/* -------------------------------------------------------------
+ * @name static float hdc1080_exp2f(float x)
+ * -------------------------------------------------------------
+ * @brief 2^x without libm. The fraction goes through a degree 5
+ * polynomial fitted for relative error on [0, 1), within 8e-8,
+ * and the whole part is put straight into the float exponent
+ * @param x -> exponent, must stay inside -126 to 127
+ * @return 2^x
+ */
+static float hdc1080_exp2f(float x){
+  int whole = (int)x;
+  if((float)whole > x){ whole--; }   /* FLOOR FOR NEGATIVE VALUES */
+  float frac = x - (float)whole;
+  float poly = 0.9999999269f + frac * (0.6931529682f + frac * (0.2401545299f +
+               frac * (0.0558236044f + frac * (0.0089925841f + frac * 0.0018762329f))));
+  union { float f; uint32_t u; } scale = { .u = (uint32_t)(whole + 127) << 23 };
+  return poly * scale.f;
+}
+
+/* -------------------------------------------------------------
+ * @name float hdc1080_dewpoint(float celsius, float humidity)
+ * -------------------------------------------------------------
+ * @brief Dewpoint using the reference polynomial, the powers
+ * are done with multiplies so no pow() or double math is used
+ * @param celsius -> temperature in °C
+ * @param humidity -> relative humidity in %
+ * @return dewpoint in °C
+ */
+float hdc1080_dewpoint(float celsius, float humidity){
+  float dryness = 1.0f - (0.01f * humidity);
+  float cube = (2.5f + 0.007f * celsius) * dryness;
+  float pow2 = dryness * dryness;
+  float pow4 = pow2 * pow2;
+  float pow8 = pow4 * pow4;
+  return celsius - (14.55f + 0.114f * celsius) * dryness - (cube * cube * cube) -
+         (15.9f + 0.117f * celsius) * (pow8 * pow4 * pow2);
+}
+
+/* -------------------------------------------------------------
+ * @name float hdc1080_svp(float celsius)
+ * -------------------------------------------------------------
+ * @brief Air saturation vapor pressure
+ * @param celsius -> temperature in °C
+ * @return saturation vapor pressure in pascals
+ */
+float hdc1080_svp(float celsius){
+  return 610.78f * hdc1080_exp2f((17.2694f * HDC1080_LOG2E) * celsius / (celsius + 237.3f));
+}
+
+/* -------------------------------------------------------------
+ * @name float hdc1080_vpd(float svp, float humidity)
+ * -------------------------------------------------------------
+ * @brief Air vapor pressure deficit
+ * @param svp -> saturation vapor pressure in pascals
+ * @param humidity -> relative humidity in %
+ * @return vapor pressure deficit in kPa
+ */
+float hdc1080_vpd(float svp, float humidity){
+  return svp * (1.0f - (0.01f * humidity)) * 0.001f;
+}
+
+/* -------------------------------------------------------------
+ * @name int16_t hdc1080_dewpoint_fixed(int16_t centi_celsius, uint16_t centi_humidity)
+ * -------------------------------------------------------------
+ * @brief Integer only dewpoint using the reference polynomial.
+ * The dryness (1 - RH/100) is carried as a Q16 fraction
+ * @param centi_celsius -> temperature in centi-degrees
+ * @param centi_humidity -> relative humidity in centi-percent
+ * @return dewpoint in centi-degrees
+ */
+int16_t hdc1080_dewpoint_fixed(int16_t centi_celsius, uint16_t centi_humidity){
+  if(centi_humidity > 10000){ centi_humidity = 10000; }
+  int64_t t = centi_celsius;
+  int64_t dryness = (((int64_t)(10000 - centi_humidity) << 16) + 5000) / 10000;   /* Q16 */
+  /* THE COEFFICIENTS ARE SCALED BY 100000, WITH t IN CENTI-DEGREES 0.114T BECOMES 114t */
+  /* (14.55 + 0.114T) * DRYNESS, IN CENTI-DEGREES * 1000 */
+  int64_t linear = ((1455000 + 114 * t) * dryness) >> 16;
+  /* ((2.5 + 0.007T) * DRYNESS)^3, THE BASE IN Q16 */
+  int64_t base = ((250000 + 7 * t) * dryness) / 100000;
+  int64_t cube = (((base * base) >> 16) * base) >> 16;
+  /* (15.9 + 0.117T) * DRYNESS^14, IN CENTI-DEGREES * 1000 */
+  int64_t pow2 = (dryness * dryness) >> 16;
+  int64_t pow4 = (pow2 * pow2) >> 16;
+  int64_t pow8 = (pow4 * pow4) >> 16;
+  int64_t pow14 = (((pow8 * pow4) >> 16) * pow2) >> 16;
+  int64_t tail = ((1590000 + 117 * t) * pow14) >> 16;
+  int64_t dewpoint = t - ((linear + tail + 500) / 1000) - (((cube * 100) + 32768) >> 16);
+  return (int16_t)dewpoint;
+}
+
+/* -------------------------------------------------------------
+ * @name uint32_t hdc1080_svp_fixed(int16_t centi_celsius)
+ * -------------------------------------------------------------
+ * @brief Integer only saturation vapor pressure, linear
+ * interpolation between whole degree table entries
+ * @param centi_celsius -> temperature in centi-degrees, clamped
+ *        to the -40°C to 125°C range of the HDC1080
+ * @return saturation vapor pressure in pascals
+ */
+uint32_t hdc1080_svp_fixed(int16_t centi_celsius){
+  int32_t offset = (int32_t)centi_celsius - (HDC1080_SVP_TABLE_MIN * 100);
+  if(offset < 0){ offset = 0; }
+  if(offset > (HDC1080_SVP_TABLE_LEN - 1) * 100){ offset = (HDC1080_SVP_TABLE_LEN - 1) * 100; }
+  int32_t index = offset / 100;
+  int32_t frac = offset - (index * 100);
+  if(index == HDC1080_SVP_TABLE_LEN - 1){ return (hdc1080_svp_table[index] + 50) / 100; }
+  uint32_t low = hdc1080_svp_table[index];
+  uint32_t high = hdc1080_svp_table[index + 1];
+  /* CENTI-PASCALS * 100 FOR THE FRACTION, BACK TO PASCALS ROUNDED */
+  uint64_t svp = ((uint64_t)low * 100) + ((uint64_t)(high - low) * frac);
+  return (uint32_t)((svp + 5000) / 10000);
+}
+
+/* -------------------------------------------------------------
+ * @name uint32_t hdc1080_vpd_fixed(uint32_t svp, uint16_t centi_humidity)
+ * -------------------------------------------------------------
+ * @brief Integer only air vapor pressure deficit
+ * @param svp -> saturation vapor pressure in pascals
+ * @param centi_humidity -> relative humidity in centi-percent
+ * @return vapor pressure deficit in pascals
+ */
+uint32_t hdc1080_vpd_fixed(uint32_t svp, uint16_t centi_humidity){
+  if(centi_humidity > 10000){ centi_humidity = 10000; }
+  return (uint32_t)((((uint64_t)svp * (10000 - centi_humidity)) + 5000) / 10000);
+}
+
+/* -------------------------------------------------------------
+ * @name void hdc1080_psychro_batch(const hdc1080_sensor_readings_t * readings, hdc1080_psychro_t * psychro, size_t count)
+ * -------------------------------------------------------------
+ * @brief Work out every float metric for an array of readings
+ * @param readings -> the readings to process
+ * @param psychro -> array of at least count entries to fill
+ * @param count -> number of readings
+ */
+void hdc1080_psychro_batch(const hdc1080_sensor_readings_t * readings, hdc1080_psychro_t * psychro, size_t count){
+  for(size_t i = 0; i < count; i++){
+    psychro[i].dewpoint = hdc1080_dewpoint(readings[i].temperature, readings[i].humidity);
+    psychro[i].svp = hdc1080_svp(readings[i].temperature);
+    psychro[i].vpd = hdc1080_vpd(psychro[i].svp, readings[i].humidity);
+  }
+}
+
+/* -------------------------------------------------------------
+ * @name void hdc1080_psychro_batch_fixed(const hdc1080_fixed_readings_t * readings, hdc1080_psychro_fixed_t * psychro, size_t count)
+ * -------------------------------------------------------------
+ * @brief Work out every fixed point metric for an array of readings
+ * @param readings -> the readings to process
+ * @param psychro -> array of at least count entries to fill
+ * @param count -> number of readings
+ */
+void hdc1080_psychro_batch_fixed(const hdc1080_fixed_readings_t * readings, hdc1080_psychro_fixed_t * psychro, size_t count){
+  for(size_t i = 0; i < count; i++){
+    psychro[i].dewpoint = hdc1080_dewpoint_fixed(readings[i].temperature, readings[i].humidity);
+    psychro[i].svp = hdc1080_svp_fixed(readings[i].temperature);
+    psychro[i].vpd = hdc1080_vpd_fixed(psychro[i].svp, readings[i].humidity);
+  }
+}
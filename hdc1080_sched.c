@@ -0,0 +1,513 @@
+/*
+ * ESP32 HDC1080 COMPONENT DRIVER LIBRARY
+ * Copyright 2023 Open grStat
+ *
+ * SPDX-FileCopyrightText: 2023 Open grStat https://github.com/grstat
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: Created by Adrian Borchardt
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "hdc1080.h"
+#include "hdc1080_sched.h"
+
+#define HDC1080_SCHED_WAKE  0x01  /* PORT TASK NOTIFICATION, THE WAKE TIMER EXPIRED */
+#define HDC1080_SCHED_EXIT  0x02  /* PORT TASK NOTIFICATION, THE SCHEDULER IS STOPPING */
+
+/* ONE SENSOR AS THE PORT TASK SEES IT
+ * sensor_id -> INDEX IN THE SCHEDULER, HANDED TO THE CALLBACK
+ * mux_address/mux_channel -> ROUTE TO THE SENSOR
+ * handle -> THE DRIVER INSTANCE, CONFIGURED WHEN THE SENSOR WAS ADDED
+ * pending -> TRUE WHILE THIS CYCLE'S CONVERSION HAS NOT BEEN READ
+ * ready_at -> esp_timer TIME THE CONVERSION CAN BE READ
+ * sample -> THIS CYCLE'S SAMPLE */
+typedef struct HDC1080_SCHED_ENTRY {
+  int sensor_id;
+  unsigned char mux_address;
+  unsigned char mux_channel;
+  hdc1080_handle_t handle;
+  bool pending;
+  int64_t ready_at;
+  hdc1080_sample_t sample;
+} hdc1080_sched_entry_t;
+
+/* ONE PORT AND THE TASK THAT DRIVES IT
+ * sched -> THE OWNING SCHEDULER
+ * i2c_port_number/bus -> WHERE THE TRAFFIC GOES
+ * entries -> THE SENSORS ON THIS PORT SORTED BY MUX AND CHANNEL
+ * muxes -> EVERY MUX SEEN ON THIS PORT
+ * route_known -> FALSE UNTIL THE MUX STATE IS KNOWN, e.g. AFTER A FAILED WRITE
+ * route_mux/route_channel -> WHAT IS ROUTED TO THE PORT RIGHT NOW
+ * task_h -> THE PORT TASK
+ * wake_timer_h -> ONE SHOT TIMER THE PORT TASK SLEEPS ON
+ * done -> GIVEN BY THE PORT TASK ONCE IT HAS STOPPED
+ * exit_requested -> SET WHEN HDC1080_SCHED_EXIT ARRIVES MID CYCLE
+ * stats -> CYCLE COUNTERS */
+typedef struct HDC1080_SCHED_PORT {
+  struct hdc1080_sched_t * sched;
+  unsigned char i2c_port_number;
+  hdc1080_bus_t bus;
+  hdc1080_sched_entry_t * entries[HDC1080_SCHED_MAX_SENSORS];
+  int entry_count;
+  unsigned char muxes[HDC1080_SCHED_MAX_MUXES];
+  int mux_count;
+  bool route_known;
+  unsigned char route_mux;
+  unsigned char route_channel;
+  TaskHandle_t task_h;
+  esp_timer_handle_t wake_timer_h;
+  SemaphoreHandle_t done;
+  bool exit_requested;
+  hdc1080_sched_stats_t stats;
+} hdc1080_sched_port_t;
+
+/* THE SCHEDULER
+ * settings -> COPY OF THE SCHEDULER SETTINGS
+ * entries/sensor_count -> EVERY SENSOR ADDED, INDEXED BY sensor_id
+ * ports/port_count -> EVERY PORT SEEN
+ * running -> TRUE BETWEEN hdc1080_sched_start AND hdc1080_sched_stop */
+struct hdc1080_sched_t {
+  hdc1080_sched_settings_t settings;
+  hdc1080_sched_entry_t entries[HDC1080_SCHED_MAX_SENSORS];
+  int sensor_count;
+  hdc1080_sched_port_t ports[HDC1080_SCHED_MAX_PORTS];
+  int port_count;
+  bool running;
+};
+
+static hdc1080_sched_port_t * hdc1080_sched_find_port(hdc1080_sched_handle_t sched, unsigned char i2c_port_number);
+static esp_err_t hdc1080_sched_route(hdc1080_sched_port_t * port, unsigned char mux_address, unsigned char mux_channel);
+static esp_err_t hdc1080_sched_mux_write(hdc1080_sched_port_t * port, unsigned char mux_address, unsigned char channels);
+static void hdc1080_sched_port_task(void * arg);
+static int64_t hdc1080_sched_run_cycle(hdc1080_sched_port_t * port);
+static bool hdc1080_sched_sleep_until(hdc1080_sched_port_t * port, int64_t wake_at, bool interruptible);
+static void hdc1080_sched_wake(void * arg);
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sched_create(const hdc1080_sched_settings_t * sched_settings, hdc1080_sched_handle_t * sched_handle)
+ * ----------------------------------------------------------------------
+ * @brief Create an empty scheduler
+ * @param sched_settings -> period, callback and task settings
+ * @param sched_handle -> filled with the new scheduler
+ * @return ESP_OK on success
+ */
+esp_err_t hdc1080_sched_create(const hdc1080_sched_settings_t * sched_settings, hdc1080_sched_handle_t * sched_handle){
+  if(sched_settings == NULL || sched_handle == NULL || sched_settings->callback == NULL){ return ESP_ERR_INVALID_ARG; }
+  hdc1080_sched_handle_t sched = calloc(1, sizeof(struct hdc1080_sched_t));
+  if(sched == NULL){ return ESP_ERR_NO_MEM; }
+  memmove(&sched->settings, sched_settings, sizeof(hdc1080_sched_settings_t));
+  *sched_handle = sched;
+  return ESP_OK;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sched_delete(hdc1080_sched_handle_t sched_handle)
+ * ----------------------------------------------------------------------
+ * @brief Release a scheduler and every sensor instance it created
+ * @param sched_handle -> scheduler to release
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE while it is running,
+ *         otherwise the first hdc1080_delete error, e.g. HDC1080_CONVERTING
+ *         when a measurement was started on a sensor instance and not
+ *         fetched or aborted. The scheduler is kept but only
+ *         hdc1080_sched_delete may be called on it again, the instances
+ *         already released are skipped
+ */
+esp_err_t hdc1080_sched_delete(hdc1080_sched_handle_t sched_handle){
+  if(sched_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(sched_handle->running){ return ESP_ERR_INVALID_STATE; }
+  esp_err_t err_ck = ESP_OK;
+  for(int i = 0; i < sched_handle->sensor_count; i++){
+    if(sched_handle->entries[i].handle == NULL){ continue; }
+    esp_err_t err_delete = hdc1080_delete(sched_handle->entries[i].handle);
+    if(err_delete == ESP_OK){
+      sched_handle->entries[i].handle = NULL;
+    }else if(err_ck == ESP_OK){
+      err_ck = err_delete;
+    }
+  }
+  if(err_ck != ESP_OK){ return err_ck; }
+  free(sched_handle);
+  return ESP_OK;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sched_add_sensor(hdc1080_sched_handle_t sched_handle, const hdc1080_sched_sensor_t * sensor, int * sensor_id)
+ * ----------------------------------------------------------------------
+ * @brief Route to a sensor, configure it and add it to its port
+ * @param sched_handle -> handle returned from hdc1080_sched_create
+ * @param sensor -> where the sensor is and how to configure it
+ * @param sensor_id -> filled with the id the callback reports, may be NULL
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE while running,
+ *         ESP_ERR_NO_MEM when a sensor, port or mux limit is reached,
+ *         otherwise the hdc1080_configure error
+ * @note Runs on the calling task, the bus must be idle
+ */
+esp_err_t hdc1080_sched_add_sensor(hdc1080_sched_handle_t sched_handle, const hdc1080_sched_sensor_t * sensor, int * sensor_id){
+  if(sched_handle == NULL || sensor == NULL || sensor->mux_channel > 7){ return ESP_ERR_INVALID_ARG; }
+  if(sched_handle->running){ return ESP_ERR_INVALID_STATE; }
+  if(sched_handle->sensor_count >= HDC1080_SCHED_MAX_SENSORS){ return ESP_ERR_NO_MEM; }
+  hdc1080_bus_t bus = sensor->bus;
+  if(bus.transfer == NULL){ hdc1080_bus_i2c_driver(sensor->i2c_port_number, &bus); }
+  hdc1080_sched_port_t * port = hdc1080_sched_find_port(sched_handle, sensor->i2c_port_number);
+  if(port == NULL){
+    if(sched_handle->port_count >= HDC1080_SCHED_MAX_PORTS){ return ESP_ERR_NO_MEM; }
+    port = &sched_handle->ports[sched_handle->port_count++];
+    port->sched = sched_handle;
+    port->i2c_port_number = sensor->i2c_port_number;
+    port->bus = bus;
+  }else if(port->bus.transfer != bus.transfer || port->bus.bus_ctx != bus.bus_ctx){
+    return ESP_ERR_INVALID_ARG;
+  }
+  // A NEW MUX MAY HAVE CHANNELS LEFT ON FROM BEFORE, FORGET THE ROUTE SO EVERY MUX GETS CLEARED
+  if(sensor->mux_address != HDC1080_SCHED_NO_MUX){
+    bool known = false;
+    for(int i = 0; i < port->mux_count; i++){ known |= (port->muxes[i] == sensor->mux_address); }
+    if(!known){
+      if(port->mux_count >= HDC1080_SCHED_MAX_MUXES){ return ESP_ERR_NO_MEM; }
+      port->muxes[port->mux_count++] = sensor->mux_address;
+      port->route_known = false;
+    }
+  }
+  esp_err_t err_ck = hdc1080_sched_route(port, sensor->mux_address, sensor->mux_channel);
+  if(err_ck != ESP_OK){ return err_ck; }
+  hdc1080_sched_entry_t * entry = &sched_handle->entries[sched_handle->sensor_count];
+  hdc1080_settings_t hdc_settings = {
+    .i2c_address = sensor->i2c_address,
+    .i2c_port_number = sensor->i2c_port_number,
+    .timeout_length = sched_handle->settings.timeout_length,
+    .completion_mode = sensor->completion_mode,
+    .channel = sensor->channel,
+    .bus = bus,
+    .warm_start = sensor->warm_start,
+    .health = sensor->health
+  };
+  err_ck = hdc1080_configure(&hdc_settings, sensor->config, &entry->handle);
+  if(err_ck != ESP_OK){ return err_ck; }
+  entry->sensor_id = sched_handle->sensor_count;
+  entry->mux_address = sensor->mux_address;
+  entry->mux_channel = sensor->mux_channel;
+  // KEEP THE PORT SORTED BY MUX AND CHANNEL SO A CYCLE VISITS EACH ROUTE ONCE PER PASS
+  int slot = port->entry_count;
+  while(slot > 0){
+    hdc1080_sched_entry_t * before = port->entries[slot - 1];
+    if(before->mux_address < entry->mux_address || (before->mux_address == entry->mux_address && before->mux_channel <= entry->mux_channel)){ break; }
+    port->entries[slot] = before;
+    slot--;
+  }
+  port->entries[slot] = entry;
+  port->entry_count++;
+  if(sensor_id != NULL){ *sensor_id = entry->sensor_id; }
+  sched_handle->sensor_count++;
+  return ESP_OK;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sched_start(hdc1080_sched_handle_t sched_handle)
+ * ----------------------------------------------------------------------
+ * @brief Start one task per port, the first cycle runs right away
+ * @param sched_handle -> handle returned from hdc1080_sched_create
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already running
+ */
+esp_err_t hdc1080_sched_start(hdc1080_sched_handle_t sched_handle){
+  if(sched_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(sched_handle->running){ return ESP_ERR_INVALID_STATE; }
+  UBaseType_t priority = sched_handle->settings.task_priority;
+  if(priority == 0){ priority = HDC1080_SCHED_PRIORITY; }
+  esp_err_t err_ck = ESP_OK;
+  int started = 0;
+  for(; started < sched_handle->port_count; started++){
+    hdc1080_sched_port_t * port = &sched_handle->ports[started];
+    const esp_timer_create_args_t hdc1080_sched_timer_args = {
+      .callback = &hdc1080_sched_wake,
+      .arg = port,
+      .name = "hdc1080_sched_timer"
+    };
+    port->exit_requested = false;
+    port->done = xSemaphoreCreateBinary();
+    if(port->done == NULL){
+      err_ck = ESP_ERR_NO_MEM;
+      break;
+    }
+    err_ck = esp_timer_create(&hdc1080_sched_timer_args, &port->wake_timer_h);
+    if(err_ck != ESP_OK){
+      vSemaphoreDelete(port->done);
+      break;
+    }
+    if(xTaskCreate(hdc1080_sched_port_task, "hdc1080_sched", HDC1080_SCHED_STACK_SIZE, port, priority, &port->task_h) != pdPASS){
+      esp_timer_delete(port->wake_timer_h);
+      vSemaphoreDelete(port->done);
+      err_ck = ESP_ERR_NO_MEM;
+      break;
+    }
+  }
+  sched_handle->running = true;
+  if(err_ck != ESP_OK){
+    // ONLY STOP THE PORTS THAT DID START
+    int port_count = sched_handle->port_count;
+    sched_handle->port_count = started;
+    hdc1080_sched_stop(sched_handle);
+    sched_handle->port_count = port_count;
+  }
+  return err_ck;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sched_stop(hdc1080_sched_handle_t sched_handle)
+ * ----------------------------------------------------------------------
+ * @brief Stop every port task, a cycle in progress is finished first
+ * @param sched_handle -> handle returned from hdc1080_sched_create
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not running
+ */
+esp_err_t hdc1080_sched_stop(hdc1080_sched_handle_t sched_handle){
+  if(sched_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  if(!sched_handle->running){ return ESP_ERR_INVALID_STATE; }
+  for(int i = 0; i < sched_handle->port_count; i++){
+    xTaskNotify(sched_handle->ports[i].task_h, HDC1080_SCHED_EXIT, eSetBits);
+  }
+  for(int i = 0; i < sched_handle->port_count; i++){
+    hdc1080_sched_port_t * port = &sched_handle->ports[i];
+    xSemaphoreTake(port->done, portMAX_DELAY);
+    esp_timer_delete(port->wake_timer_h);
+    vSemaphoreDelete(port->done);
+    port->task_h = NULL;
+  }
+  sched_handle->running = false;
+  return ESP_OK;
+}
+
+/* ----------------------------------------------------------------------
+ * @name hdc1080_handle_t hdc1080_sched_get_handle(hdc1080_sched_handle_t sched_handle, int sensor_id)
+ * ----------------------------------------------------------------------
+ * @brief Get the driver instance of a sensor, e.g. for hdc1080_get_stats
+ * @param sched_handle -> handle returned from hdc1080_sched_create
+ * @param sensor_id -> id returned from hdc1080_sched_add_sensor
+ * @return the instance, NULL for an unknown id
+ * @note Requests on the instance are rejected while it is scheduled
+ */
+hdc1080_handle_t hdc1080_sched_get_handle(hdc1080_sched_handle_t sched_handle, int sensor_id){
+  if(sched_handle == NULL || sensor_id < 0 || sensor_id >= sched_handle->sensor_count){ return NULL; }
+  return sched_handle->entries[sensor_id].handle;
+}
+
+/* ----------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sched_get_stats(hdc1080_sched_handle_t sched_handle, unsigned char i2c_port_number, hdc1080_sched_stats_t * stats)
+ * ----------------------------------------------------------------------
+ * @brief Copy out the cycle counters of one port
+ * @param sched_handle -> handle returned from hdc1080_sched_create
+ * @param i2c_port_number -> the port to report
+ * @param stats -> filled with the counters
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND for a port without sensors
+ */
+esp_err_t hdc1080_sched_get_stats(hdc1080_sched_handle_t sched_handle, unsigned char i2c_port_number, hdc1080_sched_stats_t * stats){
+  if(sched_handle == NULL || stats == NULL){ return ESP_ERR_INVALID_ARG; }
+  hdc1080_sched_port_t * port = hdc1080_sched_find_port(sched_handle, i2c_port_number);
+  if(port == NULL){ return ESP_ERR_NOT_FOUND; }
+  *stats = port->stats;
+  return ESP_OK;
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_sched_port_task(void * arg)
+ * -------------------------------------------------------------
+ * @brief Runs the cycles of one port until the scheduler stops
+ * @param arg -> the hdc1080_sched_port_t to drive
+ */
+static void hdc1080_sched_port_task(void * arg){
+  hdc1080_sched_port_t * port = (hdc1080_sched_port_t *)arg;
+  unsigned int period = port->sched->settings.period;
+  int64_t cycle_start = esp_timer_get_time();
+  while(hdc1080_sched_sleep_until(port, cycle_start, true)){
+    int64_t started = esp_timer_get_time();
+    int64_t idle_until = hdc1080_sched_run_cycle(port);
+    int64_t now = esp_timer_get_time();
+    port->stats.cycles++;
+    port->stats.cycle_time = (uint32_t)(now - started);
+    if(port->stats.cycle_time > port->stats.cycle_time_max){ port->stats.cycle_time_max = port->stats.cycle_time; }
+    if(port->exit_requested){ break; }
+    cycle_start += period;
+    if(cycle_start < now){
+      // THE CYCLE DID NOT FIT IN THE PERIOD, START THE NEXT ONE RIGHT AWAY
+      if(period > 0){ port->stats.overruns++; }
+      cycle_start = now;
+    }
+    // NOTHING WAS CONVERTED, e.g. EVERY SENSOR IS BACKING OFF, DO NOT SPIN ON A BACK TO BACK PERIOD
+    if(idle_until > cycle_start){ cycle_start = idle_until; }
+  }
+  esp_timer_stop(port->wake_timer_h);
+  xSemaphoreGive(port->done);
+  vTaskDelete(NULL);
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_sched_run_cycle(hdc1080_sched_port_t * port)
+ * -------------------------------------------------------------
+ * @brief Start a conversion on every sensor of the port, then read
+ * each back as soon as it is ready
+ * @param port -> the port to cycle
+ * @return 0 when a conversion was started, otherwise the esp_timer time
+ *         the next cycle should wait for, the earliest retry_at of the
+ *         sensors backing off but at least one tick from now
+ */
+static int64_t hdc1080_sched_run_cycle(hdc1080_sched_port_t * port){
+  hdc1080_sched_settings_t * settings = &port->sched->settings;
+  int pending = 0;
+  int64_t idle_until = 0;
+  // START EVERY CONVERSION BACK TO BACK, THE ENTRIES ARE SORTED SO EACH ROUTE IS SET ONCE
+  for(int i = 0; i < port->entry_count; i++){
+    hdc1080_sched_entry_t * entry = port->entries[i];
+    memset(&entry->sample, 0, sizeof(hdc1080_sample_t));
+    entry->sample.timestamp = esp_timer_get_time();
+    // A SENSOR THAT IS BACKING OFF WOULD FAIL FAST ANYWAY, DO NOT SPEND A MUX WRITE ON IT
+    hdc1080_health_state_t health = {0};
+    esp_err_t err_ck = hdc1080_get_health(entry->handle, &health);
+    if(err_ck == ESP_OK && health.failures > 0 && entry->sample.timestamp < health.retry_at){
+      err_ck = HDC1080_ERR_DOWN;
+      if(idle_until == 0 || health.retry_at < idle_until){ idle_until = health.retry_at; }
+    }
+    if(err_ck == ESP_OK){ err_ck = hdc1080_sched_route(port, entry->mux_address, entry->mux_channel); }
+    if(err_ck == ESP_OK){ err_ck = hdc1080_start_measurement(entry->handle, &entry->ready_at); }
+    entry->pending = (err_ck == ESP_OK);
+    if(entry->pending){
+      pending++;
+    }else{
+      settings->callback(entry->sensor_id, err_ck, &entry->sample, settings->user_ctx);
+    }
+  }
+  if(pending == 0){
+    int64_t next_tick = esp_timer_get_time() + (int64_t)portTICK_PERIOD_MS * 1000;
+    return (idle_until > next_tick) ? idle_until : next_tick;
+  }
+  // READ THEM BACK IN THE ORDER THEY BECOME READY, BUT ANYTHING ALREADY
+  // DUE ON THE CURRENT ROUTE GOES FIRST SINCE IT NEEDS NO MUX WRITE
+  while(pending > 0){
+    hdc1080_sched_entry_t * next = NULL;
+    int64_t now = esp_timer_get_time();
+    for(int i = 0; i < port->entry_count; i++){
+      hdc1080_sched_entry_t * entry = port->entries[i];
+      if(!entry->pending){ continue; }
+      if(entry->ready_at <= now && port->route_known && entry->mux_address == port->route_mux && entry->mux_channel == port->route_channel){
+        next = entry;
+        break;
+      }
+      if(next == NULL || entry->ready_at < next->ready_at){ next = entry; }
+    }
+    hdc1080_sched_sleep_until(port, next->ready_at, false);
+    esp_err_t err_ck = hdc1080_sched_route(port, next->mux_address, next->mux_channel);
+    if(err_ck == ESP_OK){
+      err_ck = hdc1080_fetch_measurement(next->handle, &next->sample.raw, &next->ready_at);
+      // STILL CONVERTING, ready_at WAS MOVED TO THE NEXT ATTEMPT
+      if(err_ck == HDC1080_CONVERTING){ continue; }
+    }else{
+      hdc1080_abort_measurement(next->handle);
+    }
+    next->pending = false;
+    pending--;
+    settings->callback(next->sensor_id, err_ck, &next->sample, settings->user_ctx);
+  }
+  return 0;
+}
+
+/* -------------------------------------------------------------
+ * @name static esp_err_t hdc1080_sched_route(hdc1080_sched_port_t * port, unsigned char mux_address, unsigned char mux_channel)
+ * -------------------------------------------------------------
+ * @brief Route a sensor to the port, writing only the muxes that change
+ * @param port -> the port to route
+ * @param mux_address -> mux of the sensor, HDC1080_SCHED_NO_MUX IF NONE
+ * @param mux_channel -> mux channel of the sensor
+ * @return ESP_OK on success, otherwise the mux write error
+ */
+static esp_err_t hdc1080_sched_route(hdc1080_sched_port_t * port, unsigned char mux_address, unsigned char mux_channel){
+  if(port->route_known && port->route_mux == mux_address && (mux_address == HDC1080_SCHED_NO_MUX || port->route_channel == mux_channel)){ return ESP_OK; }
+  esp_err_t err_ck = ESP_OK;
+  // ONLY ONE HDC1080 MAY ANSWER, DISCONNECT WHATEVER ANOTHER MUX ROUTES
+  for(int i = 0; i < port->mux_count && err_ck == ESP_OK; i++){
+    if(port->muxes[i] == mux_address){ continue; }
+    if(!port->route_known || port->muxes[i] == port->route_mux){
+      err_ck = hdc1080_sched_mux_write(port, port->muxes[i], 0);
+    }
+  }
+  if(err_ck == ESP_OK && mux_address != HDC1080_SCHED_NO_MUX){
+    err_ck = hdc1080_sched_mux_write(port, mux_address, (unsigned char)(1 << mux_channel));
+  }
+  port->route_known = (err_ck == ESP_OK);
+  port->route_mux = mux_address;
+  port->route_channel = mux_channel;
+  return err_ck;
+}
+
+/* -------------------------------------------------------------
+ * @name static esp_err_t hdc1080_sched_mux_write(hdc1080_sched_port_t * port, unsigned char mux_address, unsigned char channels)
+ * -------------------------------------------------------------
+ * @brief Set the enabled channel mask of a mux
+ * @param port -> the port the mux is on
+ * @param mux_address -> the mux
+ * @param channels -> one bit per channel, 0 disconnects every channel
+ * @return ESP_OK on success
+ */
+static esp_err_t hdc1080_sched_mux_write(hdc1080_sched_port_t * port, unsigned char mux_address, unsigned char channels){
+  port->stats.mux_switches++;
+  esp_err_t err_ck = port->bus.transfer(port->bus.bus_ctx, mux_address, &channels, 1, NULL, 0, port->sched->settings.timeout_length);
+  if(err_ck != ESP_OK){
+    ESP_LOGE("HDC1080", "MUX 0x%02X ON PORT %d FAILED: %s", mux_address, port->i2c_port_number, esp_err_to_name(err_ck));
+  }
+  return err_ck;
+}
+
+/* -------------------------------------------------------------
+ * @name static bool hdc1080_sched_sleep_until(hdc1080_sched_port_t * port, int64_t wake_at, bool interruptible)
+ * -------------------------------------------------------------
+ * @brief Block the port task until an esp_timer time, FreeRTOS ticks
+ * are too coarse for conversion windows so the wake timer is used
+ * @param port -> the port whose task is sleeping
+ * @param wake_at -> esp_timer time to wake up at
+ * @param interruptible -> return early when the scheduler is stopping
+ * @return false when the scheduler is stopping
+ */
+static bool hdc1080_sched_sleep_until(hdc1080_sched_port_t * port, int64_t wake_at, bool interruptible){
+  uint32_t work = 0;
+  while(true){
+    int64_t now = esp_timer_get_time();
+    TickType_t wait = 0;
+    if(wake_at > now){
+      esp_timer_stop(port->wake_timer_h);
+      esp_timer_start_once(port->wake_timer_h, wake_at - now);
+      wait = portMAX_DELAY;
+    }
+    // A WAKE LEFT OVER FROM AN EARLIER SLEEP ONLY COSTS ONE MORE LOOP
+    if(xTaskNotifyWait(0, UINT32_MAX, &work, wait) == pdTRUE && (work & HDC1080_SCHED_EXIT)){
+      port->exit_requested = true;
+    }
+    if(port->exit_requested && interruptible){ return false; }
+    if(wait == 0){ return !port->exit_requested; }
+  }
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_sched_wake(void * arg)
+ * -------------------------------------------------------------
+ * @brief callback from the wake timer
+ * @param arg -> the hdc1080_sched_port_t to wake
+ */
+static void hdc1080_sched_wake(void * arg){
+  hdc1080_sched_port_t * port = (hdc1080_sched_port_t *)arg;
+  xTaskNotify(port->task_h, HDC1080_SCHED_WAKE, eSetBits);
+}
+
+/* -------------------------------------------------------------
+ * @name static hdc1080_sched_port_t * hdc1080_sched_find_port(hdc1080_sched_handle_t sched, unsigned char i2c_port_number)
+ * -------------------------------------------------------------
+ * @brief Look up a port by number
+ * @return the port, NULL if no sensor was added on it
+ */
+static hdc1080_sched_port_t * hdc1080_sched_find_port(hdc1080_sched_handle_t sched, unsigned char i2c_port_number){
+  for(int i = 0; i < sched->port_count; i++){
+    if(sched->ports[i].i2c_port_number == i2c_port_number){ return &sched->ports[i]; }
+  }
+  return NULL;
+}
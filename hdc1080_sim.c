@@ -0,0 +1,456 @@
+/*
+ * ESP32 HDC1080 COMPONENT DRIVER LIBRARY
+ * Copyright 2023 Open grStat
+ *
+ * SPDX-FileCopyrightText: 2023 Open grStat https://github.com/grstat
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: Created by Adrian Borchardt
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "hdc1080.h"
+#include "hdc1080_sim.h"
+
+#define HDC1080_SIM_CONFIG_DEFAULT  0x1000  /* CONFIG REGISTER AFTER POWER UP OR RESET */
+#define HDC1080_SIM_CONFIG_RESET    0x8000  /* SOFTWARE RESET BIT */
+#define HDC1080_SIM_CONFIG_HEAT     0x2000  /* HEATER BIT */
+#define HDC1080_SIM_CONFIG_MODE     0x1000  /* MODE OF ACQUISITION BIT */
+#define HDC1080_SIM_CONFIG_TRES     0x0400  /* TEMPERATURE RESOLUTION BIT */
+#define HDC1080_SIM_CONFIG_HRES     0x0300  /* HUMIDITY RESOLUTION BITS */
+#define HDC1080_SIM_CONFIG_WRITABLE 0x3700  /* BITS THE HOST CAN CHANGE */
+#define HDC1080_SIM_BUS_WILDCARD    (-1)    /* DEVICE ID FOR FAULTS ON THE WHOLE BUS */
+
+/* ONE SIMULATED HDC1080
+ * device_config -> HOW IT WAS ADDED TO THE BUS
+ * pointer -> THE REGISTER POINTER
+ * config -> THE 16 BIT CONFIGURATION REGISTER
+ * temperature/humidity -> LAST CONVERTED CODES
+ * celsius/humidity_rh -> THE ENVIRONMENT WHEN NO SOURCE IS SET
+ * busy_until -> esp_timer TIME THE CURRENT CONVERSION OR RESET ENDS
+ * fault/fault_count -> INJECTED FAULT AND HOW MANY TRANSACTIONS IT LASTS */
+typedef struct HDC1080_SIM_DEVICE {
+  hdc1080_sim_device_config_t device_config;
+  unsigned char pointer;
+  unsigned short config;
+  unsigned short temperature;
+  unsigned short humidity;
+  float celsius;
+  float humidity_rh;
+  hdc1080_sim_source_t source;
+  void * source_ctx;
+  int64_t busy_until;
+  hdc1080_sim_fault_t fault;
+  uint32_t fault_count;
+} hdc1080_sim_device_t;
+
+/* ONE TCA9548A STYLE MUX, channels IS THE ENABLED CHANNEL MASK */
+typedef struct HDC1080_SIM_MUX {
+  unsigned char mux_address;
+  unsigned char channels;
+} hdc1080_sim_mux_t;
+
+/* THE SIMULATED BUS */
+struct hdc1080_sim_bus_t {
+  SemaphoreHandle_t lock;
+  uint32_t bus_frequency;
+  hdc1080_sim_device_t devices[HDC1080_SIM_MAX_DEVICES];
+  int device_count;
+  hdc1080_sim_mux_t muxes[HDC1080_SIM_MAX_MUXES];
+  int mux_count;
+  hdc1080_sim_fault_t bus_fault;
+  uint32_t bus_fault_count;
+  hdc1080_sim_stats_t stats;
+};
+
+static esp_err_t hdc1080_sim_transfer(void * bus_ctx, unsigned char i2c_address, const unsigned char * write_buff, size_t write_len, unsigned char * read_buff, size_t read_len, TickType_t timeout);
+static esp_err_t hdc1080_sim_clear(void * bus_ctx);
+static bool hdc1080_sim_take_fault(hdc1080_sim_fault_t * fault, uint32_t * fault_count, hdc1080_sim_fault_t * taken);
+static void hdc1080_sim_start_conversion(hdc1080_sim_device_t * device, int64_t now);
+static unsigned short hdc1080_sim_register(hdc1080_sim_device_t * device, unsigned char i2c_register);
+
+/* --------------------------------------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sim_create(uint32_t bus_frequency, hdc1080_sim_handle_t * sim_handle)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Create an empty simulated bus
+ * @param bus_frequency -> SCL frequency used to account bus time, 0 for 400kHz
+ * @param sim_handle -> filled with the new bus
+ * @return ESP_OK on success
+ */
+esp_err_t hdc1080_sim_create(uint32_t bus_frequency, hdc1080_sim_handle_t * sim_handle){
+  if(sim_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  hdc1080_sim_handle_t sim = calloc(1, sizeof(struct hdc1080_sim_bus_t));
+  if(sim == NULL){ return ESP_ERR_NO_MEM; }
+  sim->lock = xSemaphoreCreateMutex();
+  if(sim->lock == NULL){
+    free(sim);
+    return ESP_ERR_NO_MEM;
+  }
+  sim->bus_frequency = (bus_frequency == 0) ? 400000 : bus_frequency;
+  *sim_handle = sim;
+  return ESP_OK;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sim_delete(hdc1080_sim_handle_t sim_handle)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Release a simulated bus, every driver handle using it must be deleted first
+ * @param sim_handle -> the bus to release
+ * @return ESP_OK on success
+ */
+esp_err_t hdc1080_sim_delete(hdc1080_sim_handle_t sim_handle){
+  if(sim_handle == NULL){ return ESP_ERR_INVALID_ARG; }
+  vSemaphoreDelete(sim_handle->lock);
+  free(sim_handle);
+  return ESP_OK;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name void hdc1080_sim_get_bus(hdc1080_sim_handle_t sim_handle, hdc1080_bus_t * bus)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Fill a bus backend that talks to the simulated bus
+ * @param sim_handle -> the simulated bus
+ * @param bus -> backend to fill, usually hdc1080_settings_t.bus
+ */
+void hdc1080_sim_get_bus(hdc1080_sim_handle_t sim_handle, hdc1080_bus_t * bus){
+  bus->transfer = hdc1080_sim_transfer;
+  bus->bus_ctx = sim_handle;
+  bus->clear = hdc1080_sim_clear;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sim_add_mux(hdc1080_sim_handle_t sim_handle, unsigned char mux_address)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Add a mux, a one byte write to its address sets the enabled channel mask
+ * @param sim_handle -> the simulated bus
+ * @param mux_address -> i2c address of the mux
+ * @return ESP_OK on success
+ */
+esp_err_t hdc1080_sim_add_mux(hdc1080_sim_handle_t sim_handle, unsigned char mux_address){
+  if(sim_handle == NULL || mux_address == HDC1080_SIM_NO_MUX){ return ESP_ERR_INVALID_ARG; }
+  xSemaphoreTake(sim_handle->lock, portMAX_DELAY);
+  esp_err_t err_ck = ESP_ERR_NO_MEM;
+  if(sim_handle->mux_count < HDC1080_SIM_MAX_MUXES){
+    sim_handle->muxes[sim_handle->mux_count].mux_address = mux_address;
+    sim_handle->muxes[sim_handle->mux_count].channels = 0;
+    sim_handle->mux_count++;
+    err_ck = ESP_OK;
+  }
+  xSemaphoreGive(sim_handle->lock);
+  return err_ck;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sim_add_device(hdc1080_sim_handle_t sim_handle, const hdc1080_sim_device_config_t * device_config, int * device_id)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Add an HDC1080 in its power up state, 25°C and 50%RH
+ * @param sim_handle -> the simulated bus
+ * @param device_config -> where the device sits and how it behaves
+ * @param device_id -> filled with the id used by the other sim calls, may be NULL
+ * @return ESP_OK on success
+ */
+esp_err_t hdc1080_sim_add_device(hdc1080_sim_handle_t sim_handle, const hdc1080_sim_device_config_t * device_config, int * device_id){
+  if(sim_handle == NULL || device_config == NULL || device_config->mux_channel > 7){ return ESP_ERR_INVALID_ARG; }
+  xSemaphoreTake(sim_handle->lock, portMAX_DELAY);
+  esp_err_t err_ck = ESP_ERR_NO_MEM;
+  if(sim_handle->device_count < HDC1080_SIM_MAX_DEVICES){
+    hdc1080_sim_device_t * device = &sim_handle->devices[sim_handle->device_count];
+    memset(device, 0, sizeof(hdc1080_sim_device_t));
+    device->device_config = *device_config;
+    if(device->device_config.conversion_scale == 0){ device->device_config.conversion_scale = 100; }
+    device->config = HDC1080_SIM_CONFIG_DEFAULT;
+    device->celsius = 25.0f;
+    device->humidity_rh = 50.0f;
+    if(device_id != NULL){ *device_id = sim_handle->device_count; }
+    sim_handle->device_count++;
+    err_ck = ESP_OK;
+  }
+  xSemaphoreGive(sim_handle->lock);
+  return err_ck;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sim_set_environment(hdc1080_sim_handle_t sim_handle, int device_id, float celsius, float humidity)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Set the environment the next conversions will measure
+ * @param sim_handle -> the simulated bus
+ * @param device_id -> id from hdc1080_sim_add_device
+ * @param celsius -> temperature in °C
+ * @param humidity -> relative humidity in %
+ * @return ESP_OK on success
+ */
+esp_err_t hdc1080_sim_set_environment(hdc1080_sim_handle_t sim_handle, int device_id, float celsius, float humidity){
+  if(sim_handle == NULL || device_id < 0 || device_id >= sim_handle->device_count){ return ESP_ERR_INVALID_ARG; }
+  xSemaphoreTake(sim_handle->lock, portMAX_DELAY);
+  sim_handle->devices[device_id].celsius = celsius;
+  sim_handle->devices[device_id].humidity_rh = humidity;
+  xSemaphoreGive(sim_handle->lock);
+  return ESP_OK;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sim_set_source(hdc1080_sim_handle_t sim_handle, int device_id, hdc1080_sim_source_t source, void * source_ctx)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Script the environment, the source is asked at every conversion start
+ * @param sim_handle -> the simulated bus
+ * @param device_id -> id from hdc1080_sim_add_device
+ * @param source -> the script, NULL to go back to hdc1080_sim_set_environment
+ * @param source_ctx -> passed back to the source
+ * @return ESP_OK on success
+ * @note The source runs with the bus lock held and must not call back into the sim
+ */
+esp_err_t hdc1080_sim_set_source(hdc1080_sim_handle_t sim_handle, int device_id, hdc1080_sim_source_t source, void * source_ctx){
+  if(sim_handle == NULL || device_id < 0 || device_id >= sim_handle->device_count){ return ESP_ERR_INVALID_ARG; }
+  xSemaphoreTake(sim_handle->lock, portMAX_DELAY);
+  sim_handle->devices[device_id].source = source;
+  sim_handle->devices[device_id].source_ctx = source_ctx;
+  xSemaphoreGive(sim_handle->lock);
+  return ESP_OK;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name esp_err_t hdc1080_sim_inject_fault(hdc1080_sim_handle_t sim_handle, int device_id, hdc1080_sim_fault_t fault, uint32_t count)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Make the next count transactions fail
+ * @param sim_handle -> the simulated bus
+ * @param device_id -> id from hdc1080_sim_add_device, -1 for every transaction on the bus
+ * @param fault -> the fault, HDC1080_SIM_FAULT_NONE clears it
+ * @param count -> transactions it lasts, HDC1080_SIM_FAULT_FOREVER until cleared
+ * @return ESP_OK on success
+ */
+esp_err_t hdc1080_sim_inject_fault(hdc1080_sim_handle_t sim_handle, int device_id, hdc1080_sim_fault_t fault, uint32_t count){
+  if(sim_handle == NULL || device_id < HDC1080_SIM_BUS_WILDCARD || device_id >= sim_handle->device_count){ return ESP_ERR_INVALID_ARG; }
+  if(fault == HDC1080_SIM_FAULT_NONE){ count = 0; }
+  xSemaphoreTake(sim_handle->lock, portMAX_DELAY);
+  if(device_id == HDC1080_SIM_BUS_WILDCARD){
+    sim_handle->bus_fault = fault;
+    sim_handle->bus_fault_count = count;
+  }else{
+    sim_handle->devices[device_id].fault = fault;
+    sim_handle->devices[device_id].fault_count = count;
+  }
+  xSemaphoreGive(sim_handle->lock);
+  return ESP_OK;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name void hdc1080_sim_get_stats(hdc1080_sim_handle_t sim_handle, hdc1080_sim_stats_t * stats)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Copy out the bus traffic counters
+ * @param sim_handle -> the simulated bus
+ * @param stats -> filled with the counters
+ */
+void hdc1080_sim_get_stats(hdc1080_sim_handle_t sim_handle, hdc1080_sim_stats_t * stats){
+  xSemaphoreTake(sim_handle->lock, portMAX_DELAY);
+  *stats = sim_handle->stats;
+  xSemaphoreGive(sim_handle->lock);
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name void hdc1080_sim_reset_stats(hdc1080_sim_handle_t sim_handle)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Zero the bus traffic counters
+ * @param sim_handle -> the simulated bus
+ */
+void hdc1080_sim_reset_stats(hdc1080_sim_handle_t sim_handle){
+  xSemaphoreTake(sim_handle->lock, portMAX_DELAY);
+  memset(&sim_handle->stats, 0, sizeof(hdc1080_sim_stats_t));
+  xSemaphoreGive(sim_handle->lock);
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static esp_err_t hdc1080_sim_transfer(void * bus_ctx, unsigned char i2c_address, const unsigned char * write_buff, size_t write_len, unsigned char * read_buff, size_t read_len, TickType_t timeout)
+ * --------------------------------------------------------------------------------------------------
+ * @brief The hdc1080_bus_transfer_t of the simulated bus. Routes the
+ * transaction to a mux or to the one device visible at the address
+ * @return ESP_OK, ESP_FAIL on a NACK or ESP_ERR_TIMEOUT
+ */
+static esp_err_t hdc1080_sim_transfer(void * bus_ctx, unsigned char i2c_address, const unsigned char * write_buff, size_t write_len, unsigned char * read_buff, size_t read_len, TickType_t timeout){
+  hdc1080_sim_handle_t sim = (hdc1080_sim_handle_t)bus_ctx;
+  int64_t now = esp_timer_get_time();
+  hdc1080_sim_fault_t fault = HDC1080_SIM_FAULT_NONE;
+  esp_err_t err_ck = ESP_OK;
+  xSemaphoreTake(sim->lock, portMAX_DELAY);
+  sim->stats.transactions++;
+  /* EVERY BYTE IS 9 CLOCKS, ONE ADDRESS BYTE PER START PLUS START/STOP */
+  size_t frame_bytes = write_len + read_len + ((write_len > 0) ? 1 : 0) + ((read_len > 0) ? 1 : 0);
+  sim->stats.bus_time += ((uint64_t)((frame_bytes * 9) + 2) * 1000000) / sim->bus_frequency;
+  hdc1080_sim_take_fault(&sim->bus_fault, &sim->bus_fault_count, &fault);
+  /* FIND A MUX OR THE DEVICE THAT CAN SEE THIS TRANSACTION */
+  hdc1080_sim_mux_t * mux = NULL;
+  hdc1080_sim_device_t * device = NULL;
+  int visible = 0;
+  for(int i = 0; i < sim->mux_count; i++){
+    if(sim->muxes[i].mux_address == i2c_address){ mux = &sim->muxes[i]; }
+  }
+  for(int i = 0; i < sim->device_count && mux == NULL; i++){
+    hdc1080_sim_device_t * candidate = &sim->devices[i];
+    if(candidate->device_config.i2c_address != i2c_address){ continue; }
+    if(candidate->device_config.mux_address != HDC1080_SIM_NO_MUX){
+      bool channel_enabled = false;
+      for(int m = 0; m < sim->mux_count; m++){
+        if(sim->muxes[m].mux_address == candidate->device_config.mux_address){
+          channel_enabled = (sim->muxes[m].channels & (1 << candidate->device_config.mux_channel)) != 0;
+        }
+      }
+      if(!channel_enabled){ continue; }
+    }
+    device = candidate;
+    visible++;
+  }
+  if(device != NULL && fault == HDC1080_SIM_FAULT_NONE){
+    hdc1080_sim_take_fault(&device->fault, &device->fault_count, &fault);
+  }
+  if(fault == HDC1080_SIM_FAULT_TIMEOUT){
+    err_ck = ESP_ERR_TIMEOUT;
+  }else if(fault == HDC1080_SIM_FAULT_NACK || (mux == NULL && visible != 1)){
+    /* NOTHING THERE, OR TWO DEVICES FIGHTING OVER THE SAME ADDRESS */
+    err_ck = ESP_FAIL;
+  }else if(mux != NULL){
+    if(write_len > 0){
+      mux->channels = write_buff[write_len - 1];
+      sim->stats.mux_switches++;
+      sim->stats.bytes_written += write_len;
+    }
+    for(size_t i = 0; i < read_len; i++){ read_buff[i] = mux->channels; }
+    sim->stats.bytes_read += read_len;
+  }else if(now < device->busy_until && (read_len > 0 || (device->config & HDC1080_SIM_CONFIG_RESET))){
+    /* THE HDC1080 NACKS READS UNTIL THE CONVERSION IS DONE AND EVERYTHING WHILE RESETTING */
+    err_ck = ESP_FAIL;
+  }else{
+    if(device->config & HDC1080_SIM_CONFIG_RESET){ device->config = HDC1080_SIM_CONFIG_DEFAULT; }
+    if(write_len > 0){
+      device->pointer = write_buff[0];
+      sim->stats.bytes_written += write_len;
+      if(write_len >= 3 && device->pointer == HDC1080_CONFIG_REG){
+        unsigned short config = (unsigned short)((write_buff[1] << 8) | write_buff[2]);
+        if(config & HDC1080_SIM_CONFIG_RESET){
+          device->config = HDC1080_SIM_CONFIG_DEFAULT | HDC1080_SIM_CONFIG_RESET;
+          device->busy_until = now + HDC1080_SIM_RESET_TIME;
+        }else{
+          device->config = (device->config & ~HDC1080_SIM_CONFIG_WRITABLE) | (config & HDC1080_SIM_CONFIG_WRITABLE);
+        }
+      }else if(write_len == 1 && (device->pointer == HDC1080_TEMPERATURE_REG || device->pointer == HDC1080_HUMIDITY_REG)){
+        hdc1080_sim_start_conversion(device, now);
+        sim->stats.conversions++;
+      }
+    }
+    if(read_len > 0){
+      if(write_len > 0 && now < device->busy_until){
+        /* REPEATED START STRAIGHT INTO A MEASUREMENT THAT JUST STARTED */
+        err_ck = ESP_FAIL;
+      }else{
+        /* MEASUREMENT REGISTERS IN COMBINED MODE READ TEMPERATURE THEN HUMIDITY,
+         * EVERY OTHER REGISTER READS ITS 16 BITS AND THEN 0xFF */
+        unsigned short words[2] = { hdc1080_sim_register(device, device->pointer), 0xFFFF };
+        if(device->pointer == HDC1080_TEMPERATURE_REG && (device->config & HDC1080_SIM_CONFIG_MODE)){
+          words[1] = device->humidity;
+        }
+        for(size_t i = 0; i < read_len; i++){
+          unsigned short word = (i < 4) ? words[i / 2] : 0xFFFF;
+          read_buff[i] = (i % 2 == 0) ? (unsigned char)(word >> 8) : (unsigned char)(word & 0xFF);
+          if(fault == HDC1080_SIM_FAULT_CORRUPT){ read_buff[i] = ~read_buff[i]; }
+        }
+        sim->stats.bytes_read += read_len;
+      }
+    }
+  }
+  if(err_ck == ESP_FAIL){ sim->stats.nacks++; }
+  if(err_ck == ESP_ERR_TIMEOUT){ sim->stats.timeouts++; }
+  xSemaphoreGive(sim->lock);
+  return err_ck;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static esp_err_t hdc1080_sim_clear(void * bus_ctx)
+ * --------------------------------------------------------------------------------------------------
+ * @brief The hdc1080_bus_clear_t of the simulated bus, a fault injected
+ * on the whole bus stands for a stuck SDA and is released
+ * @return ESP_OK
+ */
+static esp_err_t hdc1080_sim_clear(void * bus_ctx){
+  hdc1080_sim_handle_t sim = (hdc1080_sim_handle_t)bus_ctx;
+  xSemaphoreTake(sim->lock, portMAX_DELAY);
+  sim->bus_fault = HDC1080_SIM_FAULT_NONE;
+  sim->bus_fault_count = 0;
+  xSemaphoreGive(sim->lock);
+  return ESP_OK;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static bool hdc1080_sim_take_fault(hdc1080_sim_fault_t * fault, uint32_t * fault_count, hdc1080_sim_fault_t * taken)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Use up one transaction of an injected fault
+ * @return true when a fault applies to this transaction
+ */
+static bool hdc1080_sim_take_fault(hdc1080_sim_fault_t * fault, uint32_t * fault_count, hdc1080_sim_fault_t * taken){
+  if(*fault == HDC1080_SIM_FAULT_NONE || *fault_count == 0){ return false; }
+  *taken = *fault;
+  if(*fault_count != HDC1080_SIM_FAULT_FOREVER){ (*fault_count)--; }
+  if(*fault_count == 0){ *fault = HDC1080_SIM_FAULT_NONE; }
+  return true;
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static void hdc1080_sim_start_conversion(hdc1080_sim_device_t * device, int64_t now)
+ * --------------------------------------------------------------------------------------------------
+ * @brief Sample the environment and mark the device busy for the
+ * datasheet conversion time of its resolution and mode
+ */
+static void hdc1080_sim_start_conversion(hdc1080_sim_device_t * device, int64_t now){
+  float celsius = device->celsius;
+  float humidity = device->humidity_rh;
+  if(device->source != NULL){ device->source(device->source_ctx, now, &celsius, &humidity); }
+  if(celsius < -40.0f){ celsius = -40.0f; }
+  if(celsius > 125.0f){ celsius = 125.0f; }
+  if(humidity < 0.0f){ humidity = 0.0f; }
+  if(humidity > 100.0f){ humidity = 100.0f; }
+  bool both = (device->config & HDC1080_SIM_CONFIG_MODE) != 0;
+  bool temperature = both || device->pointer == HDC1080_TEMPERATURE_REG;
+  bool relative = both || device->pointer == HDC1080_HUMIDITY_REG;
+  unsigned int busy = 0;
+  if(temperature){
+    /* 11 BIT RESULTS HAVE THE LOW 5 BITS CLEARED, 14 BIT THE LOW 2 */
+    bool res11 = (device->config & HDC1080_SIM_CONFIG_TRES) != 0;
+    uint32_t code = (uint32_t)(((celsius + 40.0f) / 165.0f) * 65536.0f);
+    if(code > 0xFFFF){ code = 0xFFFF; }
+    device->temperature = (unsigned short)(code & (res11 ? 0xFFE0 : 0xFFFC));
+    busy += res11 ? HDC1080_TEMPERATURE_CONVERSION_11BIT : HDC1080_TEMPERATURE_CONVERSION_14BIT;
+  }
+  if(relative){
+    unsigned int hres = (device->config & HDC1080_SIM_CONFIG_HRES) >> 8;
+    uint32_t code = (uint32_t)((humidity / 100.0f) * 65536.0f);
+    if(code > 0xFFFF){ code = 0xFFFF; }
+    switch(hres){
+      case HDC1080_HUMIDITY_RESOLUTION_8BIT: code &= 0xFF00; busy += HDC1080_HUMIDITY_CONVERSION_8BIT; break;
+      case HDC1080_HUMIDITY_RESOLUTION_11BIT: code &= 0xFFE0; busy += HDC1080_HUMIDITY_CONVERSION_11BIT; break;
+      default: code &= 0xFFFC; busy += HDC1080_HUMIDITY_CONVERSION_14BIT; break;
+    }
+    device->humidity = (unsigned short)code;
+  }
+  device->busy_until = now + ((busy * device->device_config.conversion_scale) / 100);
+}
+
+/* --------------------------------------------------------------------------------------------------
+ * @name static unsigned short hdc1080_sim_register(hdc1080_sim_device_t * device, unsigned char i2c_register)
+ * --------------------------------------------------------------------------------------------------
+ * @brief The 16 bit value of a register
+ */
+static unsigned short hdc1080_sim_register(hdc1080_sim_device_t * device, unsigned char i2c_register){
+  uint64_t serial = device->device_config.serial_id;
+  switch(i2c_register){
+    case HDC1080_TEMPERATURE_REG: return device->temperature;
+    case HDC1080_HUMIDITY_REG: return device->humidity;
+    case HDC1080_CONFIG_REG: return device->config;
+    case HDC1080_SERIALID2_REG: return (unsigned short)((serial >> 25) & 0xFFFF);
+    case HDC1080_SERIALID1_REG: return (unsigned short)((serial >> 9) & 0xFFFF);
+    case HDC1080_SERIALID0_REG: return (unsigned short)((serial & 0x1FF) << 7);
+    case HDC1080_MANUFACTURER_ID_REG: return HDC1080_MANUFACTURER_ID;
+    case HDC1080_DEVICE_ID_REG: return HDC1080_DEVICE_ID;
+    default: return 0xFFFF;
+  }
+}
@@ -0,0 +1,353 @@
+/*
+ * ESP32 HDC1080 COMPONENT DRIVER LIBRARY
+ * Copyright 2023 Open grStat
+ *
+ * SPDX-FileCopyrightText: 2023 Open grStat https://github.com/grstat
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: Created by Adrian Borchardt
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ */
+#include <string.h>
+#include "hdc1080_stream.h"
+
+#define HDC1080_STREAM_MAX_PAYLOAD  (0xFFFF)  /* THE PAYLOAD LENGTH FIELD IS 16 BITS */
+
+static void hdc1080_stream_close_frame(hdc1080_stream_encoder_t * encoder);
+static unsigned int hdc1080_stream_temperature_shift(uint8_t config_register);
+static unsigned int hdc1080_stream_humidity_shift(uint8_t config_register);
+static size_t hdc1080_stream_put_varint(uint8_t * out, uint64_t value);
+static bool hdc1080_stream_get_varint(const uint8_t * data, size_t * position, size_t end, uint64_t * value);
+static uint64_t hdc1080_stream_zigzag(int64_t value);
+static int64_t hdc1080_stream_unzigzag(uint64_t value);
+static uint16_t hdc1080_stream_crc(const uint8_t * data, size_t length);
+
+/* -------------------------------------------------------------
+ * @name void hdc1080_stream_encoder_init(hdc1080_stream_encoder_t * encoder, uint8_t * buffer, size_t capacity, uint64_t sensor_id, uint8_t config_register, uint16_t frame_samples)
+ * -------------------------------------------------------------
+ * @brief Set up an encoder on a caller buffer
+ * @param encoder -> the encoder to set up
+ * @param buffer -> where the frames are written
+ * @param capacity -> length of buffer
+ * @param sensor_id -> the serial, see hdc1080_get_serial_id
+ * @param config_register -> the config register the samples were
+ *        taken with, hdc1080_config_t.config_register
+ * @param frame_samples -> samples per frame, 0 for HDC1080_STREAM_FRAME_SAMPLES
+ */
+void hdc1080_stream_encoder_init(hdc1080_stream_encoder_t * encoder, uint8_t * buffer, size_t capacity, uint64_t sensor_id, uint8_t config_register, uint16_t frame_samples){
+  memset(encoder, 0, sizeof(hdc1080_stream_encoder_t));
+  encoder->buffer = buffer;
+  encoder->capacity = capacity;
+  encoder->sensor_id = sensor_id;
+  encoder->config_register = config_register;
+  encoder->frame_samples = (frame_samples > 0) ? frame_samples : HDC1080_STREAM_FRAME_SAMPLES;
+}
+
+/* -------------------------------------------------------------
+ * @name bool hdc1080_stream_put(hdc1080_stream_encoder_t * encoder, const hdc1080_stream_sample_t * sample)
+ * -------------------------------------------------------------
+ * @brief Append one sample, opening and closing frames as needed
+ * @param encoder -> the encoder
+ * @param sample -> the sample to append
+ * @return false when the buffer is full, the sample was not added.
+ *         Ship the buffer with hdc1080_stream_finish and
+ *         hdc1080_stream_encoder_clear, then put it again
+ */
+bool hdc1080_stream_put(hdc1080_stream_encoder_t * encoder, const hdc1080_stream_sample_t * sample){
+  if(!encoder->frame_open){
+    // A NEW FRAME NEEDS ROOM FOR ITS HEADER, ONE SAMPLE AND THE CRC
+    if(encoder->capacity - encoder->length < HDC1080_STREAM_HEADER_LEN + HDC1080_STREAM_MAX_SAMPLE_LEN + HDC1080_STREAM_CRC_LEN){ return false; }
+    uint8_t * header = &encoder->buffer[encoder->length];
+    header[0] = HDC1080_STREAM_SYNC;
+    header[1] = HDC1080_STREAM_VERSION;
+    header[2] = encoder->config_register;
+    for(int i = 0; i < 6; i++){ header[3 + i] = (uint8_t)(encoder->sensor_id >> (8 * i)); }
+    memset(&header[9], 0, 4);   /* LENGTH AND COUNT ARE FILLED IN WHEN THE FRAME IS CLOSED */
+    encoder->frame_start = encoder->length;
+    encoder->length += HDC1080_STREAM_HEADER_LEN;
+    encoder->frame_open = true;
+    encoder->frame_count = 0;
+  }
+  uint8_t encoded[HDC1080_STREAM_MAX_SAMPLE_LEN];
+  size_t encoded_len = 0;
+  hdc1080_stream_sample_t code = {
+    .timestamp = sample->timestamp,
+    .temperature = (uint16_t)(sample->temperature >> hdc1080_stream_temperature_shift(encoder->config_register)),
+    .humidity = (uint16_t)(sample->humidity >> hdc1080_stream_humidity_shift(encoder->config_register))
+  };
+  int64_t delta = 0;
+  if(encoder->frame_count == 0){
+    // EVERY FRAME STARTS ABSOLUTE SO IT DECODES ON ITS OWN
+    encoded_len += hdc1080_stream_put_varint(&encoded[encoded_len], (uint64_t)code.timestamp);
+    encoded_len += hdc1080_stream_put_varint(&encoded[encoded_len], code.temperature);
+    encoded_len += hdc1080_stream_put_varint(&encoded[encoded_len], code.humidity);
+  }else{
+    delta = code.timestamp - encoder->last.timestamp;
+    encoded_len += hdc1080_stream_put_varint(&encoded[encoded_len], hdc1080_stream_zigzag(delta - encoder->last_delta));
+    encoded_len += hdc1080_stream_put_varint(&encoded[encoded_len], hdc1080_stream_zigzag((int64_t)code.temperature - encoder->last.temperature));
+    encoded_len += hdc1080_stream_put_varint(&encoded[encoded_len], hdc1080_stream_zigzag((int64_t)code.humidity - encoder->last.humidity));
+    size_t payload = encoder->length - encoder->frame_start - HDC1080_STREAM_HEADER_LEN;
+    if(encoder->capacity - encoder->length < encoded_len + HDC1080_STREAM_CRC_LEN || payload + encoded_len > HDC1080_STREAM_MAX_PAYLOAD){
+      // NO ROOM IN THIS FRAME, CLOSE IT AND TRY ONCE MORE IN A FRESH ONE
+      hdc1080_stream_close_frame(encoder);
+      return hdc1080_stream_put(encoder, sample);
+    }
+  }
+  memcpy(&encoder->buffer[encoder->length], encoded, encoded_len);
+  encoder->length += encoded_len;
+  encoder->last = code;
+  encoder->last_delta = delta;
+  encoder->frame_count++;
+  if(encoder->frame_count >= encoder->frame_samples){ hdc1080_stream_close_frame(encoder); }
+  return true;
+}
+
+/* -------------------------------------------------------------
+ * @name size_t hdc1080_stream_encode(hdc1080_stream_encoder_t * encoder, const hdc1080_stream_sample_t * samples, size_t count)
+ * -------------------------------------------------------------
+ * @brief Append a batch of samples
+ * @param encoder -> the encoder
+ * @param samples -> the samples, oldest first
+ * @param count -> number of samples
+ * @return the number of samples added, less than count when the
+ *         buffer filled up
+ */
+size_t hdc1080_stream_encode(hdc1080_stream_encoder_t * encoder, const hdc1080_stream_sample_t * samples, size_t count){
+  size_t added = 0;
+  while(added < count && hdc1080_stream_put(encoder, &samples[added])){ added++; }
+  return added;
+}
+
+/* -------------------------------------------------------------
+ * @name size_t hdc1080_stream_finish(hdc1080_stream_encoder_t * encoder)
+ * -------------------------------------------------------------
+ * @brief Close the open frame so the buffer can be shipped
+ * @param encoder -> the encoder
+ * @return the number of bytes in the buffer
+ */
+size_t hdc1080_stream_finish(hdc1080_stream_encoder_t * encoder){
+  if(encoder->frame_open){ hdc1080_stream_close_frame(encoder); }
+  return encoder->length;
+}
+
+/* -------------------------------------------------------------
+ * @name void hdc1080_stream_encoder_clear(hdc1080_stream_encoder_t * encoder)
+ * -------------------------------------------------------------
+ * @brief Empty the buffer once it has been shipped, any frame that
+ * was not finished is dropped
+ * @param encoder -> the encoder
+ */
+void hdc1080_stream_encoder_clear(hdc1080_stream_encoder_t * encoder){
+  encoder->length = 0;
+  encoder->frame_open = false;
+}
+
+/* -------------------------------------------------------------
+ * @name void hdc1080_stream_decoder_init(hdc1080_stream_decoder_t * decoder, const uint8_t * data, size_t length)
+ * -------------------------------------------------------------
+ * @brief Set up a decoder on received bytes
+ * @param decoder -> the decoder to set up
+ * @param data -> the received frames
+ * @param length -> number of bytes in data
+ */
+void hdc1080_stream_decoder_init(hdc1080_stream_decoder_t * decoder, const uint8_t * data, size_t length){
+  memset(decoder, 0, sizeof(hdc1080_stream_decoder_t));
+  decoder->data = data;
+  decoder->length = length;
+}
+
+/* -------------------------------------------------------------
+ * @name int hdc1080_stream_decode(hdc1080_stream_decoder_t * decoder, hdc1080_stream_sample_t * sample)
+ * -------------------------------------------------------------
+ * @brief Decode the next sample, decoder->sensor_id and
+ * decoder->config_register tell which sensor it came from
+ * @param decoder -> the decoder
+ * @param sample -> filled with the sample, the codes back at 16 bits
+ * @return HDC1080_STREAM_OK, HDC1080_STREAM_END, HDC1080_STREAM_TRUNCATED
+ *         or HDC1080_STREAM_CORRUPT
+ */
+int hdc1080_stream_decode(hdc1080_stream_decoder_t * decoder, hdc1080_stream_sample_t * sample){
+  while(decoder->frame_remaining == 0){
+    if(decoder->offset >= decoder->length){ return HDC1080_STREAM_END; }
+    const uint8_t * frame = &decoder->data[decoder->offset];
+    size_t available = decoder->length - decoder->offset;
+    if(frame[0] != HDC1080_STREAM_SYNC){
+      // LOST, SKIP TO THE NEXT SYNC BYTE
+      const uint8_t * sync = memchr(frame, HDC1080_STREAM_SYNC, available);
+      decoder->offset = (sync != NULL) ? (size_t)(sync - decoder->data) : decoder->length;
+      return HDC1080_STREAM_CORRUPT;
+    }
+    if(available < HDC1080_STREAM_HEADER_LEN + HDC1080_STREAM_CRC_LEN){ return HDC1080_STREAM_TRUNCATED; }
+    size_t payload = (size_t)frame[9] | ((size_t)frame[10] << 8);
+    size_t count = (size_t)frame[11] | ((size_t)frame[12] << 8);
+    size_t frame_len = HDC1080_STREAM_HEADER_LEN + payload + HDC1080_STREAM_CRC_LEN;
+    // A SYNC BYTE FOUND INSIDE A PAYLOAD RARELY HAS A SANE HEADER BEHIND IT, CHECK
+    // BEFORE WAITING FOR MORE DATA SO A FALSE LENGTH CANNOT STALL THE DECODER
+    bool sane = (frame[1] == HDC1080_STREAM_VERSION && payload >= 3 * count && payload <= HDC1080_STREAM_MAX_SAMPLE_LEN * count);
+    if(sane && available < frame_len){ return HDC1080_STREAM_TRUNCATED; }
+    if(!sane || hdc1080_stream_crc(frame, frame_len - HDC1080_STREAM_CRC_LEN) != (uint16_t)(frame[frame_len - 2] | (frame[frame_len - 1] << 8))){
+      // THE SYNC BYTE MAY HAVE BEEN PAYLOAD, RESYNC FROM THE NEXT BYTE
+      decoder->offset++;
+      return HDC1080_STREAM_CORRUPT;
+    }
+    decoder->config_register = frame[2];
+    decoder->sensor_id = 0;
+    for(int i = 0; i < 6; i++){ decoder->sensor_id |= (uint64_t)frame[3 + i] << (8 * i); }
+    decoder->frame_total = (uint16_t)count;
+    decoder->frame_remaining = decoder->frame_total;
+    decoder->position = decoder->offset + HDC1080_STREAM_HEADER_LEN;
+    decoder->frame_end = decoder->position + payload;
+    decoder->offset += frame_len;
+  }
+  uint64_t values[3];
+  for(int i = 0; i < 3; i++){
+    if(!hdc1080_stream_get_varint(decoder->data, &decoder->position, decoder->frame_end, &values[i])){
+      // THE CRC MATCHED BUT THE PAYLOAD DOES NOT, GIVE UP ON THE FRAME
+      decoder->frame_remaining = 0;
+      return HDC1080_STREAM_CORRUPT;
+    }
+  }
+  hdc1080_stream_sample_t code;
+  if(decoder->frame_remaining == decoder->frame_total){
+    code.timestamp = (int64_t)values[0];
+    code.temperature = (uint16_t)values[1];
+    code.humidity = (uint16_t)values[2];
+    decoder->last_delta = 0;
+  }else{
+    decoder->last_delta += hdc1080_stream_unzigzag(values[0]);
+    code.timestamp = decoder->last.timestamp + decoder->last_delta;
+    code.temperature = (uint16_t)(decoder->last.temperature + hdc1080_stream_unzigzag(values[1]));
+    code.humidity = (uint16_t)(decoder->last.humidity + hdc1080_stream_unzigzag(values[2]));
+  }
+  decoder->last = code;
+  decoder->frame_remaining--;
+  sample->timestamp = code.timestamp;
+  sample->temperature = (uint16_t)(code.temperature << hdc1080_stream_temperature_shift(decoder->config_register));
+  sample->humidity = (uint16_t)(code.humidity << hdc1080_stream_humidity_shift(decoder->config_register));
+  return HDC1080_STREAM_OK;
+}
+
+/* -------------------------------------------------------------
+ * @name static void hdc1080_stream_close_frame(hdc1080_stream_encoder_t * encoder)
+ * -------------------------------------------------------------
+ * @brief Fill in the length and count of the open frame and append its CRC
+ * @param encoder -> the encoder, a frame must be open
+ */
+static void hdc1080_stream_close_frame(hdc1080_stream_encoder_t * encoder){
+  uint8_t * frame = &encoder->buffer[encoder->frame_start];
+  size_t payload = encoder->length - encoder->frame_start - HDC1080_STREAM_HEADER_LEN;
+  frame[9] = (uint8_t)payload;
+  frame[10] = (uint8_t)(payload >> 8);
+  frame[11] = (uint8_t)encoder->frame_count;
+  frame[12] = (uint8_t)(encoder->frame_count >> 8);
+  uint16_t crc = hdc1080_stream_crc(frame, encoder->length - encoder->frame_start);
+  encoder->buffer[encoder->length++] = (uint8_t)crc;
+  encoder->buffer[encoder->length++] = (uint8_t)(crc >> 8);
+  encoder->frame_open = false;
+}
+
+/* -------------------------------------------------------------
+ * @name static unsigned int hdc1080_stream_temperature_shift(uint8_t config_register)
+ * -------------------------------------------------------------
+ * @brief Low bits of a temperature code that are always 0
+ * @param config_register -> bit 2 set for 11 bit, clear for 14 bit
+ * @return 5 for 11 bit, 2 for 14 bit
+ */
+static unsigned int hdc1080_stream_temperature_shift(uint8_t config_register){
+  return (config_register & 0x04) ? 5 : 2;
+}
+
+/* -------------------------------------------------------------
+ * @name static unsigned int hdc1080_stream_humidity_shift(uint8_t config_register)
+ * -------------------------------------------------------------
+ * @brief Low bits of a humidity code that are always 0
+ * @param config_register -> bits 1-0 are 0 for 14 bit, 1 for 11 bit, 2 for 8 bit
+ * @return 8 for 8 bit, 5 for 11 bit, 2 for 14 bit
+ */
+static unsigned int hdc1080_stream_humidity_shift(uint8_t config_register){
+  switch(config_register & 0x03){
+    case 0x02: return 8;
+    case 0x01: return 5;
+    default: return 2;
+  }
+}
+
+/* -------------------------------------------------------------
+ * @name static size_t hdc1080_stream_put_varint(uint8_t * out, uint64_t value)
+ * -------------------------------------------------------------
+ * @brief LEB128, 7 bits per byte low first, the top bit says more follow
+ * @param out -> room for at least 10 bytes
+ * @param value -> the value to write
+ * @return the number of bytes written
+ */
+static size_t hdc1080_stream_put_varint(uint8_t * out, uint64_t value){
+  size_t length = 0;
+  while(value >= 0x80){
+    out[length++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[length++] = (uint8_t)value;
+  return length;
+}
+
+/* -------------------------------------------------------------
+ * @name static bool hdc1080_stream_get_varint(const uint8_t * data, size_t * position, size_t end, uint64_t * value)
+ * -------------------------------------------------------------
+ * @brief Read a varint written by hdc1080_stream_put_varint
+ * @param data -> the bytes
+ * @param position -> where to read, moved past the varint
+ * @param end -> the varint must end before this
+ * @param value -> filled with the value
+ * @return false when the varint runs past end or is too long
+ */
+static bool hdc1080_stream_get_varint(const uint8_t * data, size_t * position, size_t end, uint64_t * value){
+  uint64_t result = 0;
+  for(unsigned int shift = 0; shift < 64 && *position < end; shift += 7){
+    uint8_t byte = data[(*position)++];
+    result |= (uint64_t)(byte & 0x7F) << shift;
+    if((byte & 0x80) == 0){
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+/* -------------------------------------------------------------
+ * @name static uint64_t hdc1080_stream_zigzag(int64_t value)
+ * -------------------------------------------------------------
+ * @brief Map small negative and positive values to small unsigned
+ * ones, 0 1 -1 2 -2 BECOME 0 2 1 4 3
+ */
+static uint64_t hdc1080_stream_zigzag(int64_t value){
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+/* -------------------------------------------------------------
+ * @name static int64_t hdc1080_stream_unzigzag(uint64_t value)
+ * -------------------------------------------------------------
+ * @brief Undo hdc1080_stream_zigzag
+ */
+static int64_t hdc1080_stream_unzigzag(uint64_t value){
+  return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/* -------------------------------------------------------------
+ * @name static uint16_t hdc1080_stream_crc(const uint8_t * data, size_t length)
+ * -------------------------------------------------------------
+ * @brief CRC-16/CCITT-FALSE, polynomial 0x1021 starting from 0xFFFF.
+ * Bitwise rather than a table, a frame is checked once
+ * @param data -> the bytes to check
+ * @param length -> number of bytes
+ * @return the CRC
+ */
+static uint16_t hdc1080_stream_crc(const uint8_t * data, size_t length){
+  uint16_t crc = 0xFFFF;
+  for(size_t i = 0; i < length; i++){
+    crc ^= (uint16_t)(data[i] << 8);
+    for(int bit = 0; bit < 8; bit++){
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
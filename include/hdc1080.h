@@ -13,7 +13,12 @@
 #include <esp_err.h>
 #include <esp_log.h>
 #include <esp_event.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "hdc1080_bus.h"
+#include "hdc1080_stream.h"
 #include <math.h>
+#include <stdint.h>
 
 #define HDC1080_TEMPERATURE_REG     0x00    /* TEMPERATURE MEASUREMENT OUTPUT */
 #define HDC1080_HUMIDITY_REG        0x01    /* RELATIVE HUMIDITY MEASUREMENT OUTPUT */
@@ -41,19 +46,90 @@
 #define HDC1080_BATTERY_STATUS_LOW  0x01
 #define HDC1080_ERR_ID              0xFF
 #define HDC1080_CONVERTING          0xFE
-#define HDC1080_CONVERSION_WAIT_PERIOD   (500000) /* CONVERSION WAIT PERIOD */
+#define HDC1080_ERR_DOWN            0xFD    /* THE SENSOR IS BACKING OFF AFTER BUS FAILURES, NOTHING WAS SENT */
+
+/* CONVERSION TIMES FROM THE DATASHEET IN MICROSECONDS, THE WAIT
+ * FOR A CONVERSION IS BUILT FROM THESE BASED ON THE CONFIGURED
+ * RESOLUTIONS AND MODE OF ACQUISITION, SEE hdc1080_conversion_time */
+#define HDC1080_TEMPERATURE_CONVERSION_14BIT  (6350)
+#define HDC1080_TEMPERATURE_CONVERSION_11BIT  (3650)
+#define HDC1080_HUMIDITY_CONVERSION_14BIT     (6500)
+#define HDC1080_HUMIDITY_CONVERSION_11BIT     (3850)
+#define HDC1080_HUMIDITY_CONVERSION_8BIT      (2500)
+#define HDC1080_CONVERSION_MARGIN             (1000)  /* ADDED TO EVERY WAIT TO COVER PART AND TIMER TOLERANCE */
+#define HDC1080_POLL_INTERVAL                 (250)   /* TIME BETWEEN READ ATTEMPTS WHILE POLLING */
+
+/* WHERE FINISHED READINGS ARE SENT
+ * HDC1080_SINK_CALLBACK -> callback OR raw_callback FROM THE SETTINGS
+ * HDC1080_SINK_QUEUE -> AN hdc1080_readings_event_t IS SENT TO readings_queue
+ * HDC1080_SINK_EVENT -> AN hdc1080_readings_event_t IS POSTED AS
+ *                       HDC1080_EVENT / HDC1080_EVENT_READINGS TO event_loop,
+ *                       OR TO THE DEFAULT LOOP WHEN event_loop IS NULL */
+#define HDC1080_SINK_CALLBACK       0x00
+#define HDC1080_SINK_QUEUE          0x01
+#define HDC1080_SINK_EVENT          0x02
+#define HDC1080_WORKER_STACK_SIZE   (3072)  /* STACK OF THE OPTIONAL WORKER TASK */
+#define HDC1080_WORKER_PRIORITY     (5)     /* WORKER PRIORITY WHEN worker_priority IS 0 */
+#define HDC1080_MAX_WAITERS         (8)     /* REQUESTS THAT CAN ATTACH TO ONE CONVERSION */
+/* TASK NOTIFICATION INDEX THE DRIVER CONSUMES ON THE CALLING TASK,
+ * hdc1080_read_sync AND hdc1080_delete CLEAR IT AND WAIT ON IT SO THE
+ * APPLICATION MUST NOT USE IT. DEFAULTS TO THE LAST INDEX, RAISE
+ * CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES TO 2 OR MORE SO IT
+ * STAYS CLEAR OF INDEX 0, WHICH xTaskNotify AND xTaskNotifyGive USE */
+#ifndef HDC1080_NOTIFY_INDEX
+#define HDC1080_NOTIFY_INDEX        (configTASK_NOTIFICATION_ARRAY_ENTRIES - 1)
+#endif
+
+/* HOW A CONVERSION IS DETECTED AS FINISHED
+ * HDC1080_COMPLETION_TIMED -> WAIT THE FULL CONVERSION TIME THEN READ
+ * HDC1080_COMPLETION_POLL -> START READING AT HALF THE CONVERSION TIME
+ *                            AND RETRY EVERY HDC1080_POLL_INTERVAL WHILE
+ *                            THE HDC1080 NACKS THE READ ADDRESS */
+#define HDC1080_COMPLETION_TIMED    0x00
+#define HDC1080_COMPLETION_POLL     0x01
+
+/* WHAT A REQUEST MEASURES. WITH HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE
+ * ONE CONVERSION ALWAYS COVERS BOTH SO ONLY HDC1080_CHANNEL_BOTH IS VALID,
+ * WITH HDC1080_ACQUISITION_HUMIDITY_OR_TEMPERATURE EACH CHANNEL IS ITS OWN
+ * CONVERSION AND A 2 BYTE READ
+ * HDC1080_CHANNEL_BOTH -> TEMPERATURE AND HUMIDITY, IN SEPARATE MODE THE
+ *                         HUMIDITY CONVERSION IS STARTED AFTER THE TEMPERATURE ONE
+ * HDC1080_CHANNEL_TEMPERATURE -> TEMPERATURE ONLY, HUMIDITY READS AS NAN
+ * HDC1080_CHANNEL_HUMIDITY -> HUMIDITY ONLY, TEMPERATURE READS AS NAN
+ * THE RAW CODE OF A CHANNEL THAT WAS NOT MEASURED IS LEFT 0 */
+#define HDC1080_CHANNEL_BOTH        0x00
+#define HDC1080_CHANNEL_TEMPERATURE 0x01
+#define HDC1080_CHANNEL_HUMIDITY    0x02
+
+/* REQUEST TO RESULT LATENCY HISTOGRAM, BUCKET 0 COUNTS RESULTS FASTER
+ * THAN HDC1080_LATENCY_BUCKET_BASE, EACH FOLLOWING BUCKET DOUBLES THE
+ * UPPER EDGE AND THE LAST ONE TAKES EVERYTHING SLOWER, WITH THE
+ * DEFAULTS <2ms <4ms <8ms <16ms <32ms <64ms <128ms >=128ms */
+#define HDC1080_LATENCY_BUCKETS     (8)
+#define HDC1080_LATENCY_BUCKET_BASE (2000)  /* MICROSECONDS */
+
+/* HOW hdc1080_filter_t.oversample CONVERSIONS ARE REDUCED TO ONE */
+#define HDC1080_DECIMATE_MEAN         0x00
+#define HDC1080_DECIMATE_MEDIAN       0x01
+#define HDC1080_FILTER_MAX_OVERSAMPLE (16)  /* LONGEST DECIMATION WINDOW */
+#define HDC1080_FILTER_MAX_EMA_SHIFT  (8)   /* SLOWEST EMA, A WEIGHT OF 1/256 */
+
+#define HDC1080_WARM_START_MAGIC    0x48444331  /* MARKS A FILLED hdc1080_warm_start_t */
+#define HDC1080_PROBE_STACK_SIZE    (3072)      /* STACK OF THE hdc1080_configure_all PORT TASKS */
+
+/* BUS HEALTH, SEE hdc1080_health_t */
+#define HDC1080_BACKOFF_MIN         (10000)     /* MICROSECONDS, BACKOFF AFTER THE FIRST FAILURE WHEN backoff_min IS 0 */
+#define HDC1080_BACKOFF_MAX         (10000000)  /* MICROSECONDS, LONGEST BACKOFF WHEN backoff_max IS 0 */
+#define HDC1080_RESET_TIME          (15000)     /* MICROSECONDS THE HDC1080 NEEDS AFTER A SOFT RESET */
 
 /* CONVERT CELSIUS TO FAHRENHEIT */
 #define CEL2FAH(CELSIUS) ((1.8 * CELSIUS) + 32)
-/* CALCULATE DEWPOINT USING TEMPERATURE AND HUMIDITY */
-#define DEWPOINT(CELSIUS, RH) (CELSIUS - (14.55 + 0.114 * CELSIUS) * \
-         (1 - (0.01 * RH)) - pow(((2.5 + 0.007 * CELSIUS) * \
-         (1 - (0.01 * RH))),3) - (15.9 + 0.117 * CELSIUS) * \
-         pow((1 - (0.01 * RH)), 14))
+/* CALCULATE DEWPOINT USING TEMPERATURE AND HUMIDITY, SEE hdc1080_psychro.h */
+#define DEWPOINT(CELSIUS, RH) hdc1080_dewpoint((CELSIUS), (RH))
 /* CALCULATE AIR SATURATION VAPOR PRESSURE IN PASCALS */
-#define SVP(CELSIUS) (610.78 * pow(2.71828, (CELSIUS / (CELSIUS+237.3) * 17.2694)))
+#define SVP(CELSIUS) hdc1080_svp((CELSIUS))
 /* AIR VAPOR PRESSURE DEFICIT IN kPa */
-#define VPD(SVP, RH) ((SVP *(1 - RH/100))/1000)
+#define VPD(SVP, RH) hdc1080_vpd((SVP), (RH))
 /* CONVERT PASCALS TO kPa */
 #define PAS2KPA(PASCALS) (PASCALS / 1000)
 
@@ -78,25 +154,288 @@ typedef struct HDC1080_SENSOR_READINGS {
   float temperature;
 } hdc1080_sensor_readings_t;
 
-/* CALLBACK FOR SENSOR READINGS */
-typedef void(* hdc1080_sensor_callback)(hdc1080_sensor_readings_t);
+/* RAW SENSOR READINGS, THE 16 BIT CODES EXACTLY AS READ FROM THE HDC1080 */
+typedef struct HDC1080_RAW_READINGS {
+  unsigned short temperature;
+  unsigned short humidity;
+} hdc1080_raw_readings_t;
+
+/* FIXED POINT SENSOR READINGS
+ * temperature -> CENTI-DEGREES CELSIUS, 2416 == 24.16°C
+ * humidity -> CENTI-PERCENT RELATIVE HUMIDITY, 3712 == 37.12% */
+typedef struct HDC1080_FIXED_READINGS {
+  int16_t temperature;
+  uint16_t humidity;
+} hdc1080_fixed_readings_t;
+
+/* RAW SAMPLE AS STORED BY CONTINUOUS SAMPLING
+ * timestamp -> esp_timer_get_time() WHEN THE CONVERSION WAS STARTED
+ * raw -> THE RAW TEMPERATURE AND HUMIDITY CODES
+ * jitter -> MICROSECONDS THE CONVERSION STARTED AFTER ITS CONTINUOUS
+ *           SAMPLING SLOT, 0 FOR ANY OTHER SAMPLE. FILLS WHAT WOULD
+ *           OTHERWISE BE PADDING SO THE SAMPLE STAYS 16 BYTES */
+typedef struct HDC1080_SAMPLE {
+  int64_t timestamp;
+  hdc1080_raw_readings_t raw;
+  int32_t jitter;
+} hdc1080_sample_t;
+
+/* OPAQUE HANDLE TO ONE CONFIGURED HDC1080, CREATED BY hdc1080_configure */
+typedef struct hdc1080_dev_t * hdc1080_handle_t;
+
+/* EVENT BASE FOR HDC1080_SINK_EVENT */
+ESP_EVENT_DECLARE_BASE(HDC1080_EVENT);
+enum {
+  HDC1080_EVENT_READINGS,   /* DATA IS AN hdc1080_readings_event_t */
+};
+
+/* READINGS AS SENT TO A QUEUE OR EVENT LOOP SINK
+ * handle -> THE SENSOR THE READINGS CAME FROM
+ * user_ctx -> THE user_ctx FROM THE SENSOR SETTINGS
+ * error -> ESP_OK OR THE ERROR THE READ FAILED WITH
+ * raw -> THE RAW CODES
+ * readings -> THE CONVERTED READINGS
+ * timestamp -> esp_timer_get_time() WHEN THE CONVERSION WAS STARTED
+ * jitter -> SAME AS hdc1080_sample_t.jitter */
+typedef struct HDC1080_READINGS_EVENT {
+  hdc1080_handle_t handle;
+  void * user_ctx;
+  esp_err_t error;
+  hdc1080_raw_readings_t raw;
+  hdc1080_sensor_readings_t readings;
+  int64_t timestamp;
+  int32_t jitter;
+} hdc1080_readings_event_t;
+
+/* PER SENSOR COUNTERS AS RETURNED BY hdc1080_get_stats, EVERY COUNT
+ * IS SINCE hdc1080_configure OR THE LAST hdc1080_reset_stats
+ * conversions_started -> CONVERSIONS TRIGGERED ON THE DEVICE
+ * conversions_completed -> CONVERSIONS READ BACK WITHOUT AN ERROR
+ * retries -> READS REPEATED WHILE POLLING FOR THE END OF A CONVERSION
+ * errors_nack -> ESP_FAIL, THE DEVICE DID NOT ACK
+ * errors_timeout -> ESP_ERR_TIMEOUT, THE BUS TRANSACTION TIMED OUT
+ * errors_invalid_state -> ESP_ERR_INVALID_STATE, e.g. THE i2c DRIVER IS NOT INSTALLED
+ * errors_other -> ANY OTHER ERROR
+ * converting -> CALLS REJECTED WITH HDC1080_CONVERTING
+ * sink_dropped -> READINGS LOST TO A FULL READINGS QUEUE
+ * decimated -> CONVERSIONS HELD BACK TO BE DECIMATED WITH THE NEXT ONES
+ * suppressed -> RESULTS HELD BACK BY THE DEADBAND
+ * samples_dropped -> SAMPLES LOST TO A FULL CONTINUOUS SAMPLING RING
+ * bus_transactions -> i2c TRANSACTIONS RUN
+ * bus_time -> MICROSECONDS SPENT BLOCKED IN THOSE TRANSACTIONS
+ * latency_max -> SLOWEST REQUEST TO RESULT TIME IN MICROSECONDS
+ * latency -> REQUEST TO RESULT HISTOGRAM, SEE HDC1080_LATENCY_BUCKETS
+ * missed_slots -> CONTINUOUS SAMPLING SLOTS THAT STARTED NO CONVERSION,
+ *                 THE LAST ONE WAS STILL IN FLIGHT, THE SENSOR WAS BACKING
+ *                 OFF, THE START FAILED OR THE SLOT WENT BY WHILE THE LOCK
+ *                 WAS BUSY. SAMPLES PLUS missed_slots ADD UP TO THE SLOTS
+ * jitter_max -> LATEST CONTINUOUS SAMPLING CONVERSION START AGAINST ITS
+ *               SLOT IN MICROSECONDS, A SLOT A PERIOD LATE COUNTS AS MISSED
+ * fast_failed -> CALLS REJECTED WITH HDC1080_ERR_DOWN WITHOUT TOUCHING THE BUS
+ * recoveries -> BUS CLEAR, SOFT RESET AND CONFIG RESTORE RUNS THAT BROUGHT
+ *               THE SENSOR BACK
+ * recoveries_failed -> RECOVERY RUNS THAT DID NOT */
+typedef struct HDC1080_STATS {
+  uint32_t conversions_started;
+  uint32_t conversions_completed;
+  uint32_t retries;
+  uint32_t errors_nack;
+  uint32_t errors_timeout;
+  uint32_t errors_invalid_state;
+  uint32_t errors_other;
+  uint32_t converting;
+  uint32_t sink_dropped;
+  uint32_t decimated;
+  uint32_t suppressed;
+  uint32_t samples_dropped;
+  uint32_t bus_transactions;
+  uint32_t bus_time;
+  uint32_t latency_max;
+  uint32_t latency[HDC1080_LATENCY_BUCKETS];
+  uint32_t missed_slots;
+  uint32_t jitter_max;
+  uint32_t fast_failed;
+  uint32_t recoveries;
+  uint32_t recoveries_failed;
+} hdc1080_stats_t;
+
+/* OPTIONAL BUS HEALTH TRACKING, A failure_threshold OF 0 TURNS IT OFF AND
+ * EVERY CALL GOES TO THE BUS. A NACK OR A TIMEOUT IS A FAILURE, AFTER ONE
+ * EVERY CALL THAT NEEDS THE BUS FAILS FAST WITH HDC1080_ERR_DOWN FOR THE
+ * BACKOFF, THEN ONE CALL IS LET THROUGH. THE BACKOFF STARTS AT backoff_min
+ * AND DOUBLES WITH EVERY FAILURE IN A ROW UP TO backoff_max. ONCE
+ * failure_threshold FAILURES IN A ROW ARE REACHED THE SENSOR IS DOWN AND
+ * THE CALL LET THROUGH FIRST RECOVERS IT, THE BUS CLEAR OF THE BACKEND
+ * RUNS, THE HDC1080 IS SOFT RESET AND ITS CONFIG RESTORED. THE BUILT IN
+ * esp-idf BACKEND ONLY RESETS THE i2c FIFOS, SEE hdc1080_bus_t. ANY
+ * SUCCESSFUL BUS OPERATION CLEARS THE FAILURES. A RECOVERY BLOCKS THE CALLER FOR HDC1080_RESET_TIME, SO IT
+ * NEVER RUNS IN THE esp_timer TASK, CONTINUOUS SAMPLING RECOVERS IN ITS
+ * WORKER TASK, ONE SHOT REQUESTS READ IN THE esp_timer TASK LEAVE IT TO THE
+ * NEXT CALL FROM A TASK OR hdc1080_recover
+ * failure_threshold -> FAILURES IN A ROW THAT MARK THE SENSOR DOWN
+ * backoff_min -> MICROSECONDS, 0 FOR HDC1080_BACKOFF_MIN
+ * backoff_max -> MICROSECONDS, 0 FOR HDC1080_BACKOFF_MAX */
+typedef struct HDC1080_HEALTH {
+  unsigned char failure_threshold;
+  unsigned int backoff_min;
+  unsigned int backoff_max;
+} hdc1080_health_t;
+
+/* HEALTH OF ONE SENSOR AS RETURNED BY hdc1080_get_health
+ * down -> failure_threshold WAS REACHED, THE NEXT CALL LET THROUGH RECOVERS IT
+ * failures -> FAILED BUS OPERATIONS IN A ROW
+ * retry_at -> esp_timer TIME UNTIL WHICH CALLS FAIL FAST, 0 WHEN HEALTHY */
+typedef struct HDC1080_HEALTH_STATE {
+  bool down;
+  unsigned int failures;
+  int64_t retry_at;
+} hdc1080_health_state_t;
+
+/* OPTIONAL READINGS PROCESSING, SEE hdc1080_filter.h. ALL 0 PASSES EVERY
+ * CONVERSION STRAIGHT THROUGH
+ * oversample -> CONVERSIONS REDUCED TO EACH RESULT, 0 OR 1 DISABLES DECIMATION
+ * decimation -> HDC1080_DECIMATE_MEAN OR HDC1080_DECIMATE_MEDIAN
+ * ema_shift -> EMA WEIGHT OF 1/2^ema_shift, 0 DISABLES THE EMA
+ * temperature_deadband -> CENTI-DEGREES THE TEMPERATURE MUST MOVE TO BE REPORTED
+ * humidity_deadband -> CENTI-PERCENT THE HUMIDITY MUST MOVE TO BE REPORTED
+ * max_silence -> MICROSECONDS AFTER WHICH A RESULT IS REPORTED EVEN IF
+ *                NOTHING MOVED, 0 WAITS FOR A CHANGE FOREVER */
+typedef struct HDC1080_FILTER {
+  unsigned char oversample;
+  unsigned char decimation;
+  unsigned char ema_shift;
+  uint16_t temperature_deadband;
+  uint16_t humidity_deadband;
+  unsigned int max_silence;
+} hdc1080_filter_t;
+
+/* BRING UP CACHE FOR ONE SENSOR, KEEP IT IN MEMORY THAT SURVIVES DEEP
+ * SLEEP, e.g. static RTC_DATA_ATTR hdc1080_warm_start_t warm_start[N];
+ * AND HAND IT TO hdc1080_configure THROUGH hdc1080_settings_t.warm_start.
+ * ON A COLD START THE DRIVER VERIFIES THE IDs AS USUAL, READS THE SERIAL
+ * AND FILLS THE CACHE. AFTER A DEEP SLEEP WAKE A FILLED CACHE FOR THE SAME
+ * PORT AND ADDRESS IS TRUSTED, THE ID CHECKS AND THE CONFIG READ ARE SKIPPED
+ * AND THE CONFIG REGISTER IS ONLY WRITTEN WHEN IT CHANGED. ONLY USE IT WHEN
+ * THE HDC1080 STAYS POWERED THROUGH DEEP SLEEP, CLEAR IT WITH memset WHEN
+ * THE SENSOR MAY HAVE BEEN SWAPPED OR RESET. THE FIELDS ARE FILLED BY THE
+ * DRIVER, serial_id MAY BE READ
+ * magic/checksum -> TELL A FILLED CACHE FROM CLEARED OR RANDOM MEMORY
+ * i2c_address/i2c_port_number -> WHERE THE VERIFIED SENSOR SITS
+ * config_register -> CONFIG LAST WRITTEN TO IT
+ * serial_id -> ITS 41 BIT SERIAL */
+typedef struct HDC1080_WARM_START {
+  uint32_t magic;
+  uint8_t i2c_address;
+  uint8_t i2c_port_number;
+  uint8_t config_register;
+  uint8_t reserved;
+  uint64_t serial_id;
+  uint32_t checksum;
+} hdc1080_warm_start_t;
+
+/* CALLBACK FOR SENSOR READINGS, user_ctx IS THE VALUE SET IN THE SETTINGS */
+typedef void(* hdc1080_sensor_callback)(hdc1080_sensor_readings_t, void *);
+
+/* CALLBACK FOR RAW SENSOR READINGS, SKIPS THE FLOAT CONVERSION ENTIRELY */
+typedef void(* hdc1080_raw_callback)(hdc1080_raw_readings_t, void *);
 
 /* PORT AND CALLBACK SETTINGS
  * i2c_address -> HDC1080 i2c ADDRESS
  * i2c_port_number -> THE CONFIGURED i2c PORT
  * timeout_length -> THE LENGTH TO WAIT FOR A READ/WRITE TIMEOUT
  * callback -> THE CALLBACK FUNCTION TO RETURN THE SENSOR DATA TO
- *             EXP: void temperature_readings_callback(hdc1080_sensor_readings_t sens_readings)
+ *             EXP: void temperature_readings_callback(hdc1080_sensor_readings_t sens_readings, void * user_ctx)
+ * raw_callback -> OPTIONAL, WHEN SET IT IS CALLED WITH THE RAW CODES
+ *                 INSTEAD OF callback BEING CALLED WITH FLOATS
+ * user_ctx -> PASSED BACK TO THE CALLBACK, USEFUL TO TELL SENSORS APART
+ * completion_mode -> HDC1080_COMPLETION_TIMED OR HDC1080_COMPLETION_POLL
+ * channel -> HDC1080_CHANNEL_BOTH, HDC1080_CHANNEL_TEMPERATURE OR
+ *            HDC1080_CHANNEL_HUMIDITY, CAN BE CHANGED WITH hdc1080_set_channel
+ * sample_buffer_length -> NUMBER OF SAMPLES THE CONTINUOUS SAMPLING RING
+ *                         HOLDS, MUST BE A POWER OF 2, 0 DISABLES THE RING
+ *                         AND CONTINUOUS SAMPLES GO TO THE SINK INSTEAD.
+ *                         THE CALLBACKS MAY BE NULL WHEN THE RING, ANOTHER SINK
+ *                         OR ONLY hdc1080_read_sync/hdc1080_request_readings_cb ARE USED
+ * sink -> HDC1080_SINK_CALLBACK, HDC1080_SINK_QUEUE OR HDC1080_SINK_EVENT
+ * readings_queue -> QUEUE OF hdc1080_readings_event_t FOR HDC1080_SINK_QUEUE
+ * event_loop -> LOOP FOR HDC1080_SINK_EVENT, NULL FOR THE DEFAULT LOOP
+ * use_worker_task -> WHEN TRUE THE CONVERSION TIMER ONLY WAKES A DRIVER OWNED
+ *                    TASK WHICH DOES THE i2c READ AND THE DELIVERY, OTHERWISE
+ *                    ONE SHOT REQUESTS ARE READ IN THE esp_timer TASK. CONTINUOUS
+ *                    SAMPLING ALWAYS RUNS IN THE WORKER, hdc1080_start_continuous
+ *                    CREATES IT WHEN THIS IS FALSE
+ * worker_priority -> PRIORITY OF THE WORKER TASK, 0 FOR HDC1080_WORKER_PRIORITY
+ * bus -> OPTIONAL BUS BACKEND, LEAVE bus.transfer NULL FOR THE esp-idf i2c
+ *        DRIVER ON i2c_port_number. SEE hdc1080_sim.h FOR A SIMULATED BUS
+ * filter -> PROCESSING APPLIED TO THE READINGS FOR THE SINK AND THE
+ *           CONTINUOUS SAMPLING RING, CAN BE CHANGED WITH hdc1080_set_filter.
+ *           ONE SHOT CALLBACKS AND hdc1080_read_sync ALWAYS GET THE
+ *           CONVERSION AS READ
+ * warm_start -> OPTIONAL BRING UP CACHE, SEE hdc1080_warm_start_t
+ * health -> OPTIONAL BACKOFF AND RECOVERY AFTER BUS FAILURES, SEE hdc1080_health_t
  */
 typedef struct HDC1080_SETTINGS {
   unsigned char i2c_address;
   unsigned char i2c_port_number;
   TickType_t timeout_length;
   hdc1080_sensor_callback callback;
+  hdc1080_raw_callback raw_callback;
+  void * user_ctx;
+  unsigned char completion_mode;
+  unsigned char channel;
+  unsigned int sample_buffer_length;
+  unsigned char sink;
+  QueueHandle_t readings_queue;
+  esp_event_loop_handle_t event_loop;
+  bool use_worker_task;
+  UBaseType_t worker_priority;
+  hdc1080_bus_t bus;
+  hdc1080_filter_t filter;
+  hdc1080_warm_start_t * warm_start;
+  hdc1080_health_t health;
 } hdc1080_settings_t;
 
-esp_err_t hdc1080_configure(hdc1080_settings_t * hdc1080_settings, hdc1080_config_t hdc_cfg);
-esp_err_t hdc1080_request_readings(void);
-esp_err_t hdc1080_get_configuration(hdc1080_config_t * hdc_cfg);
+/* RAW CODE TO CENTI-DEGREES CELSIUS, ((CODE / 2^16) * 165 - 40) * 100 ROUNDED */
+static inline int16_t hdc1080_temperature_centi(unsigned short temperature_code){
+  return (int16_t)((int32_t)((((uint32_t)temperature_code * 16500u) + 32768u) >> 16) - 4000);
+}
+
+/* RAW CODE TO CENTI-PERCENT RELATIVE HUMIDITY, (CODE / 2^16) * 100 * 100 ROUNDED */
+static inline uint16_t hdc1080_humidity_centi(unsigned short humidity_code){
+  return (uint16_t)((((uint32_t)humidity_code * 10000u) + 32768u) >> 16);
+}
+
+esp_err_t hdc1080_configure(hdc1080_settings_t * hdc1080_settings, hdc1080_config_t hdc_cfg, hdc1080_handle_t * hdc_handle);
+esp_err_t hdc1080_configure_all(hdc1080_settings_t * hdc1080_settings, const hdc1080_config_t * hdc_cfgs, hdc1080_handle_t * hdc_handles, esp_err_t * results, size_t count);
+esp_err_t hdc1080_delete(hdc1080_handle_t hdc_handle);
+esp_err_t hdc1080_request_readings(hdc1080_handle_t hdc_handle);
+esp_err_t hdc1080_request_readings_cb(hdc1080_handle_t hdc_handle, hdc1080_sensor_callback callback, void * user_ctx);
+esp_err_t hdc1080_read_sync(hdc1080_handle_t hdc_handle, hdc1080_sensor_readings_t * sens_readings, TickType_t timeout);
+esp_err_t hdc1080_start_measurement(hdc1080_handle_t hdc_handle, int64_t * ready_at);
+esp_err_t hdc1080_fetch_measurement(hdc1080_handle_t hdc_handle, hdc1080_raw_readings_t * raw, int64_t * ready_at);
+esp_err_t hdc1080_abort_measurement(hdc1080_handle_t hdc_handle);
+esp_err_t hdc1080_get_configuration(hdc1080_handle_t hdc_handle, hdc1080_config_t * hdc_cfg);
+esp_err_t hdc1080_set_configuration(hdc1080_handle_t hdc_handle, hdc1080_config_t hdc_cfg);
+esp_err_t hdc1080_get_serial_id(hdc1080_handle_t hdc_handle, uint64_t * serial_id);
+esp_err_t hdc1080_set_channel(hdc1080_handle_t hdc_handle, unsigned char channel);
+esp_err_t hdc1080_set_filter(hdc1080_handle_t hdc_handle, const hdc1080_filter_t * filter);
+unsigned int hdc1080_conversion_time(hdc1080_config_t hdc_cfg);
+unsigned int hdc1080_channel_conversion_time(hdc1080_config_t hdc_cfg, unsigned char channel);
+esp_err_t hdc1080_start_continuous(hdc1080_handle_t hdc_handle, unsigned int period);
+esp_err_t hdc1080_stop_continuous(hdc1080_handle_t hdc_handle);
+size_t hdc1080_drain_samples(hdc1080_handle_t hdc_handle, hdc1080_sample_t * samples, size_t max_samples);
+esp_err_t hdc1080_get_stats(hdc1080_handle_t hdc_handle, hdc1080_stats_t * stats);
+esp_err_t hdc1080_reset_stats(hdc1080_handle_t hdc_handle);
+esp_err_t hdc1080_get_health(hdc1080_handle_t hdc_handle, hdc1080_health_state_t * health);
+esp_err_t hdc1080_recover(hdc1080_handle_t hdc_handle);
+void hdc1080_raw_to_fixed(const hdc1080_raw_readings_t * raw, hdc1080_fixed_readings_t * fixed, size_t count);
+void hdc1080_raw_to_float(const hdc1080_raw_readings_t * raw, hdc1080_sensor_readings_t * readings, size_t count);
+void hdc1080_samples_to_fixed(const hdc1080_sample_t * samples, hdc1080_fixed_readings_t * fixed, size_t count);
+size_t hdc1080_stream_encode_samples(hdc1080_stream_encoder_t * encoder, const hdc1080_sample_t * samples, size_t count);
+
+/* THE DERIVED METRIC FUNCTIONS BEHIND DEWPOINT, SVP AND VPD */
+#include "hdc1080_psychro.h"
+/* THE READINGS FILTER BEHIND hdc1080_filter_t */
+#include "hdc1080_filter.h"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+/*
+ * ESP32 HDC1080 COMPONENT DRIVER LIBRARY
+ * Copyright 2023 Open grStat
+ *
+ * SPDX-FileCopyrightText: 2023 Open grStat https://github.com/grstat
+ * SPDX-FileType: HEADER
+ * SPDX-FileContributor: Created by Adrian Borchardt
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ */
+#ifndef __HDC1080_BUS_H__
+#define __HDC1080_BUS_H__
+#include <stddef.h>
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+
+/* ONE i2c TRANSACTION, SAME CONTRACT AS THE BUILT IN i2c DRIVER BACKEND
+ * bus_ctx -> THE bus_ctx FROM THE hdc1080_bus_t
+ * i2c_address -> 7 BIT DEVICE ADDRESS
+ * write_buff/write_len -> BYTES TO WRITE FIRST, write_len MAY BE 0
+ * read_buff/read_len -> BYTES TO READ AFTER A REPEATED START, read_len MAY BE 0
+ * timeout -> TICKS TO WAIT FOR THE BUS
+ * RETURNS ESP_OK, ESP_FAIL WHEN THE DEVICE NACKS OR ESP_ERR_TIMEOUT */
+typedef esp_err_t(* hdc1080_bus_transfer_t)(void * bus_ctx, unsigned char i2c_address, const unsigned char * write_buff, size_t write_len, unsigned char * read_buff, size_t read_len, TickType_t timeout);
+
+/* OPTIONAL BUS CLEAR, RUN WHEN A SENSOR IS RECOVERED BEFORE IT IS SOFT
+ * RESET. IT SHOULD FREE A DEVICE HOLDING SDA LOW, e.g. CLOCK SCL UNTIL
+ * SDA IS RELEASED AND SEND A STOP, AND RESET THE CONTROLLER
+ * bus_ctx -> THE bus_ctx FROM THE hdc1080_bus_t
+ * RETURNS ESP_OK WHEN THE BUS IS IDLE */
+typedef esp_err_t(* hdc1080_bus_clear_t)(void * bus_ctx);
+
+/* BUS BACKEND, LEAVE transfer NULL TO USE THE esp-idf i2c DRIVER
+ * ON hdc1080_settings_t.i2c_port_number. clear MAY BE NULL WHEN THE
+ * BACKEND HAS NO WAY TO CLEAR THE BUS. THE CLEAR OF THE BUILT IN
+ * BACKEND ONLY RESETS THE i2c FIFOS, IT DOES NOT KNOW THE PINS, SO AN
+ * APPLICATION THAT NEEDS A STUCK SDA FREED SHOULD WRAP THE BUILT IN
+ * BACKEND FROM hdc1080_bus_i2c_driver WITH ITS OWN clear */
+typedef struct HDC1080_BUS {
+  hdc1080_bus_transfer_t transfer;
+  void * bus_ctx;
+  hdc1080_bus_clear_t clear;
+} hdc1080_bus_t;
+
+/* FILLS bus WITH THE BUILT IN esp-idf i2c DRIVER BACKEND FOR i2c_port_number */
+void hdc1080_bus_i2c_driver(unsigned char i2c_port_number, hdc1080_bus_t * bus);
+
+#endif
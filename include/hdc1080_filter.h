@@ -0,0 +1,58 @@
+/*
+ * ESP32 HDC1080 COMPONENT DRIVER LIBRARY
+ * Copyright 2023 Open grStat
+ *
+ * SPDX-FileCopyrightText: 2023 Open grStat https://github.com/grstat
+ * SPDX-FileType: HEADER
+ * SPDX-FileContributor: Created by Adrian Borchardt
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ */
+#ifndef __HDC1080_FILTER_H__
+#define __HDC1080_FILTER_H__
+#include <stdbool.h>
+#include <stdint.h>
+#include "hdc1080.h"
+
+/* READINGS PROCESSING BETWEEN THE CONVERSION AND THE SINK, ALL INTEGER
+ * MATH ON THE RAW CODES. EACH STAGE IS OFF WHEN ITS SETTING IS 0
+ * 1. DECIMATION -> oversample CONVERSIONS ARE COLLECTED AND REDUCED TO
+ *                  ONE BY THEIR MEAN OR MEDIAN
+ * 2. EMA -> ema = ema + (code - ema) / 2^ema_shift ON THE DECIMATED CODES
+ * 3. DEADBAND -> THE RESULT IS ONLY PASSED ON WHEN TEMPERATURE OR HUMIDITY
+ *                MOVED BY AT LEAST ITS DEADBAND SINCE THE LAST ONE PASSED
+ *                ON, OR max_silence MICROSECONDS WENT BY WITHOUT ONE.
+ *                A CHANNEL WITH A 0 DEADBAND NEVER TRIGGERS, BOTH AT 0
+ *                PASSES EVERYTHING ON
+ * THE DRIVER RUNS THIS ON EVERY SUCCESSFUL CONVERSION BOUND FOR THE SINK
+ * OR THE CONTINUOUS SAMPLING RING, THE FUNCTIONS BELOW ARE PUBLIC SO THE
+ * SAME STAGE CAN BE USED ON THE hdc1080_sched READINGS */
+
+/* WHAT hdc1080_filter_push DID WITH A CONVERSION */
+#define HDC1080_FILTER_PASS         0x00  /* raw HOLDS A RESULT TO PASS ON */
+#define HDC1080_FILTER_DECIMATED    0x01  /* KEPT FOR DECIMATION, NOTHING TO PASS ON YET */
+#define HDC1080_FILTER_SUPPRESSED   0x02  /* WITHIN THE DEADBAND, NOTHING TO PASS ON */
+
+/* FILTER STATE, ZERO IT OR CALL hdc1080_filter_reset BEFORE FIRST USE
+ * window/window_count -> CONVERSIONS COLLECTED FOR THE NEXT DECIMATION
+ * ema_primed -> FALSE UNTIL THE FIRST CODE SEEDS THE EMA
+ * ema_temperature/ema_humidity -> EMA OF THE CODES WITH 8 FRACTIONAL BITS
+ * reported -> FALSE UNTIL THE FIRST RESULT WAS PASSED ON
+ * last_reported -> THE LAST RESULT PASSED ON IN CENTI UNITS
+ * last_reported_at -> esp_timer TIME OF THE LAST RESULT PASSED ON */
+typedef struct HDC1080_FILTER_STATE {
+  hdc1080_raw_readings_t window[HDC1080_FILTER_MAX_OVERSAMPLE];
+  unsigned char window_count;
+  bool ema_primed;
+  int32_t ema_temperature;
+  int32_t ema_humidity;
+  bool reported;
+  hdc1080_fixed_readings_t last_reported;
+  int64_t last_reported_at;
+} hdc1080_filter_state_t;
+
+bool hdc1080_filter_valid(const hdc1080_filter_t * filter);
+void hdc1080_filter_reset(hdc1080_filter_state_t * state);
+unsigned char hdc1080_filter_push(const hdc1080_filter_t * filter, hdc1080_filter_state_t * state, unsigned char channel, hdc1080_raw_readings_t * raw, int64_t now);
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * ESP32 HDC1080 COMPONENT DRIVER LIBRARY
+ * Copyright 2023 Open grStat
+ *
+ * SPDX-FileCopyrightText: 2023 Open grStat https://github.com/grstat
+ * SPDX-FileType: HEADER
+ * SPDX-FileContributor: Created by Adrian Borchardt
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ */
+#ifndef __HDC1080_PSYCHRO_H__
+#define __HDC1080_PSYCHRO_H__
+#include <stddef.h>
+#include <stdint.h>
+#include "hdc1080.h"
+
+/* DERIVED AIR METRICS FOR HDC1080 READINGS
+ *
+ * THE REFERENCE FORMULAS ARE THE ONES THE OLD DEWPOINT/SVP/VPD MACROS USED
+ * DEWPOINT -> T - (14.55 + 0.114T)(1 - RH/100) - ((2.5 + 0.007T)(1 - RH/100))^3
+ *             - (15.9 + 0.117T)(1 - RH/100)^14
+ * SVP      -> 610.78 * e^(17.2694 * T / (T + 237.3)) PASCALS
+ * VPD      -> SVP * (1 - RH/100) / 1000 kPa
+ *
+ * ERROR BOUNDS AGAINST THE DOUBLE PRECISION REFERENCE
+ * OVER -40°C TO 125°C AND 0% TO 100% RH
+ * hdc1080_dewpoint -> SINGLE PRECISION ROUNDING ONLY, WITHIN 0.001°C
+ * hdc1080_svp -> DEGREE 5 POLYNOMIAL FOR 2^x, WITHIN 0.0005% RELATIVE
+ * hdc1080_vpd -> SAME RELATIVE ERROR AS THE SVP PASSED IN
+ * hdc1080_dewpoint_fixed -> WITHIN 0.02°C (2 CENTI-DEGREES)
+ * hdc1080_svp_fixed -> 1°C TABLE WITH LINEAR INTERPOLATION,
+ *                      WITHIN 0.15% RELATIVE PLUS 0.5Pa ROUNDING
+ * hdc1080_vpd_fixed -> SAME AS hdc1080_svp_fixed PLUS 0.5Pa ROUNDING
+ */
+
+/* FLOAT DERIVED METRICS FOR ONE READING */
+typedef struct HDC1080_PSYCHRO {
+  float dewpoint;   /* °C */
+  float svp;        /* Pa */
+  float vpd;        /* kPa */
+} hdc1080_psychro_t;
+
+/* FIXED POINT DERIVED METRICS FOR ONE READING */
+typedef struct HDC1080_PSYCHRO_FIXED {
+  int16_t dewpoint; /* CENTI-DEGREES CELSIUS */
+  uint32_t svp;     /* Pa */
+  uint32_t vpd;     /* Pa */
+} hdc1080_psychro_fixed_t;
+
+float hdc1080_dewpoint(float celsius, float humidity);
+float hdc1080_svp(float celsius);
+float hdc1080_vpd(float svp, float humidity);
+int16_t hdc1080_dewpoint_fixed(int16_t centi_celsius, uint16_t centi_humidity);
+uint32_t hdc1080_svp_fixed(int16_t centi_celsius);
+uint32_t hdc1080_vpd_fixed(uint32_t svp, uint16_t centi_humidity);
+void hdc1080_psychro_batch(const hdc1080_sensor_readings_t * readings, hdc1080_psychro_t * psychro, size_t count);
+void hdc1080_psychro_batch_fixed(const hdc1080_fixed_readings_t * readings, hdc1080_psychro_fixed_t * psychro, size_t count);
+
+#endif
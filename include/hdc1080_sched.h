@@ -0,0 +1,109 @@
+/*
+ * ESP32 HDC1080 COMPONENT DRIVER LIBRARY
+ * Copyright 2023 Open grStat
+ *
+ * SPDX-FileCopyrightText: 2023 Open grStat https://github.com/grstat
+ * SPDX-FileType: HEADER
+ * SPDX-FileContributor: Created by Adrian Borchardt
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ */
+#ifndef __HDC1080_SCHED_H__
+#define __HDC1080_SCHED_H__
+#include <stdint.h>
+#include <stdbool.h>
+#include "hdc1080.h"
+
+/* PIPELINED SCHEDULER FOR MANY HDC1080S ON SEVERAL PORTS, DIRECTLY OR
+ * BEHIND TCA9548A STYLE MUXES. EVERY HDC1080 SITS AT THE SAME ADDRESS
+ * SO ONLY ONE OF THEM MAY BE ROUTED TO A PORT AT A TIME. EACH CYCLE
+ * THE PORT TASK STARTS THE CONVERSION ON EVERY SENSOR BACK TO BACK,
+ * SORTED BY MUX AND CHANNEL, THEN READS EACH ONE BACK AS ITS
+ * CONVERSION WINDOW EXPIRES SO THE CONVERSIONS OF ALL SENSORS OVERLAP.
+ * A MUX IS ONLY WRITTEN WHEN THE ROUTE ACTUALLY CHANGES. EVERY PORT
+ * RUNS IN ITS OWN TASK SO PORTS PROCEED IN PARALLEL. PREFER
+ * HDC1080_COMPLETION_TIMED BEHIND A MUX, EVERY NACKED POLL OF ONE SENSOR
+ * HANDS THE PORT TO ANOTHER ROUTE AND COSTS MUX WRITES */
+
+#define HDC1080_SCHED_MAX_SENSORS   (64)    /* SENSORS PER SCHEDULER */
+#define HDC1080_SCHED_MAX_PORTS     (4)     /* PORTS PER SCHEDULER, ONE TASK EACH */
+#define HDC1080_SCHED_MAX_MUXES     (8)     /* MUXES PER PORT */
+#define HDC1080_SCHED_NO_MUX        (0x00)  /* SENSOR SITS DIRECTLY ON THE PORT */
+#define HDC1080_SCHED_STACK_SIZE    (3072)  /* STACK OF EACH PORT TASK */
+#define HDC1080_SCHED_PRIORITY      (5)     /* PORT TASK PRIORITY WHEN task_priority IS 0 */
+
+/* OPAQUE HANDLE TO A SCHEDULER, CREATED BY hdc1080_sched_create */
+typedef struct hdc1080_sched_t * hdc1080_sched_handle_t;
+
+/* CALLED FROM THE PORT TASK FOR EVERY SENSOR EVERY CYCLE
+ * sensor_id -> THE ID hdc1080_sched_add_sensor RETURNED
+ * error -> ESP_OK OR WHY THE SENSOR COULD NOT BE READ
+ * sample -> timestamp IS WHEN THE CONVERSION WAS STARTED, raw IS 0 ON ERROR
+ * user_ctx -> THE user_ctx FROM THE SCHEDULER SETTINGS */
+typedef void(* hdc1080_sched_callback)(int sensor_id, esp_err_t error, const hdc1080_sample_t * sample, void * user_ctx);
+
+/* SCHEDULER SETTINGS
+ * period -> MICROSECONDS BETWEEN CYCLE STARTS, 0 RUNS CYCLES BACK TO BACK
+ * timeout_length -> TICKS TO WAIT FOR THE BUS ON EVERY TRANSACTION
+ * callback -> RECEIVES THE READINGS, SEE hdc1080_sched_callback
+ * user_ctx -> PASSED BACK TO THE CALLBACK
+ * task_priority -> PRIORITY OF THE PORT TASKS, 0 FOR HDC1080_SCHED_PRIORITY */
+typedef struct HDC1080_SCHED_SETTINGS {
+  unsigned int period;
+  TickType_t timeout_length;
+  hdc1080_sched_callback callback;
+  void * user_ctx;
+  UBaseType_t task_priority;
+} hdc1080_sched_settings_t;
+
+/* ONE SENSOR ON THE SCHEDULER
+ * i2c_port_number -> PORT THE SENSOR OR ITS MUX IS ON, SENSORS ARE GROUPED BY IT
+ * bus -> BUS BACKEND OF THE PORT, LEAVE bus.transfer NULL FOR THE esp-idf
+ *        i2c DRIVER. EVERY SENSOR ON A PORT MUST GIVE THE SAME BACKEND
+ * mux_address -> ADDRESS OF THE MUX, HDC1080_SCHED_NO_MUX IF NONE
+ * mux_channel -> MUX CHANNEL 0-7
+ * i2c_address -> USUALLY HDC1080_I2C_ADDRESS
+ * config -> THE REGISTER CONFIGURATION TO WRITE
+ * channel -> HDC1080_CHANNEL_BOTH, HDC1080_CHANNEL_TEMPERATURE OR HDC1080_CHANNEL_HUMIDITY
+ * completion_mode -> HDC1080_COMPLETION_TIMED OR HDC1080_COMPLETION_POLL
+ * warm_start -> OPTIONAL BRING UP CACHE OF THIS SENSOR, SEE hdc1080_warm_start_t.
+ *               SENSORS BEHIND A MUX SHARE A PORT AND ADDRESS SO EACH NEEDS ITS OWN
+ * health -> OPTIONAL BACKOFF AND RECOVERY, SEE hdc1080_health_t. WHILE A SENSOR
+ *           BACKS OFF THE CYCLE SKIPS IT WITHOUT SWITCHING THE MUX AND HANDS
+ *           HDC1080_ERR_DOWN TO THE CALLBACK */
+typedef struct HDC1080_SCHED_SENSOR {
+  unsigned char i2c_port_number;
+  hdc1080_bus_t bus;
+  unsigned char mux_address;
+  unsigned char mux_channel;
+  unsigned char i2c_address;
+  hdc1080_config_t config;
+  unsigned char channel;
+  unsigned char completion_mode;
+  hdc1080_warm_start_t * warm_start;
+  hdc1080_health_t health;
+} hdc1080_sched_sensor_t;
+
+/* PER PORT COUNTERS, WRITTEN ONLY BY THE PORT TASK
+ * cycles -> CYCLES RUN
+ * overruns -> CYCLES THAT TOOK LONGER THAN period
+ * mux_switches -> WRITES TO A MUX CONTROL REGISTER
+ * cycle_time -> MICROSECONDS THE LAST CYCLE TOOK
+ * cycle_time_max -> MICROSECONDS THE SLOWEST CYCLE TOOK */
+typedef struct HDC1080_SCHED_STATS {
+  uint32_t cycles;
+  uint32_t overruns;
+  uint32_t mux_switches;
+  uint32_t cycle_time;
+  uint32_t cycle_time_max;
+} hdc1080_sched_stats_t;
+
+esp_err_t hdc1080_sched_create(const hdc1080_sched_settings_t * sched_settings, hdc1080_sched_handle_t * sched_handle);
+esp_err_t hdc1080_sched_delete(hdc1080_sched_handle_t sched_handle);
+esp_err_t hdc1080_sched_add_sensor(hdc1080_sched_handle_t sched_handle, const hdc1080_sched_sensor_t * sensor, int * sensor_id);
+esp_err_t hdc1080_sched_start(hdc1080_sched_handle_t sched_handle);
+esp_err_t hdc1080_sched_stop(hdc1080_sched_handle_t sched_handle);
+hdc1080_handle_t hdc1080_sched_get_handle(hdc1080_sched_handle_t sched_handle, int sensor_id);
+esp_err_t hdc1080_sched_get_stats(hdc1080_sched_handle_t sched_handle, unsigned char i2c_port_number, hdc1080_sched_stats_t * stats);
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * ESP32 HDC1080 COMPONENT DRIVER LIBRARY
+ * Copyright 2023 Open grStat
+ *
+ * SPDX-FileCopyrightText: 2023 Open grStat https://github.com/grstat
+ * SPDX-FileType: HEADER
+ * SPDX-FileContributor: Created by Adrian Borchardt
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ */
+#ifndef __HDC1080_SIM_H__
+#define __HDC1080_SIM_H__
+#include <stdint.h>
+#include <stdbool.h>
+#include "hdc1080_bus.h"
+
+/* SIMULATED i2c BUS WITH HDC1080 DEVICES AND OPTIONAL TCA9548A STYLE
+ * MUXES. IT MODELS THE REGISTER MAP, THE POINTER REGISTER, CONVERSION
+ * TIMING PER RESOLUTION, NACKS WHILE CONVERTING OR RESETTING AND CAN
+ * INJECT BUS FAULTS. HAND IT TO THE DRIVER THROUGH hdc1080_settings_t.bus
+ * TO RUN EVERYTHING ON A HOST BUILD WITHOUT HARDWARE. ONLY BUILT FOR THE
+ * esp-idf LINUX TARGET */
+
+#define HDC1080_SIM_MAX_DEVICES     (32)
+#define HDC1080_SIM_MAX_MUXES       (8)
+#define HDC1080_SIM_NO_MUX          (0x00)    /* DEVICE SITS DIRECTLY ON THE BUS */
+#define HDC1080_SIM_RESET_TIME      (15000)   /* MICROSECONDS A SOFT RESET KEEPS THE DEVICE BUSY */
+#define HDC1080_SIM_FAULT_FOREVER   (UINT32_MAX)
+
+/* FAULTS THAT CAN BE INJECTED INTO A DEVICE
+ * HDC1080_SIM_FAULT_NONE -> CLEAR ANY FAULT
+ * HDC1080_SIM_FAULT_NACK -> THE DEVICE NACKS ITS ADDRESS
+ * HDC1080_SIM_FAULT_TIMEOUT -> THE TRANSACTION TIMES OUT
+ * HDC1080_SIM_FAULT_CORRUPT -> READS RETURN INVERTED DATA
+ * A FAULT INJECTED ON THE WHOLE BUS STANDS FOR A STUCK BUS, THE BUS
+ * CLEAR OF hdc1080_sim_get_bus RELEASES IT */
+typedef enum {
+  HDC1080_SIM_FAULT_NONE = 0,
+  HDC1080_SIM_FAULT_NACK,
+  HDC1080_SIM_FAULT_TIMEOUT,
+  HDC1080_SIM_FAULT_CORRUPT,
+} hdc1080_sim_fault_t;
+
+/* SCRIPTED ENVIRONMENT, CALLED AT THE START OF EVERY CONVERSION
+ * source_ctx -> THE source_ctx GIVEN WITH THE SOURCE
+ * now -> esp_timer_get_time() AT THE CONVERSION START
+ * celsius/humidity -> FILL WITH THE ENVIRONMENT THE DEVICE SEES */
+typedef void(* hdc1080_sim_source_t)(void * source_ctx, int64_t now, float * celsius, float * humidity);
+
+/* A SIMULATED DEVICE
+ * i2c_address -> USUALLY HDC1080_I2C_ADDRESS
+ * mux_address -> ADDRESS OF THE MUX IT HANGS OFF, HDC1080_SIM_NO_MUX IF NONE
+ * mux_channel -> MUX CHANNEL 0-7
+ * serial_id -> 41 BIT SERIAL REPORTED THROUGH THE SERIALID REGISTERS
+ * conversion_scale -> PERCENT OF THE DATASHEET CONVERSION TIME THE DEVICE
+ *                     TAKES, 0 IS TREATED AS 100 */
+typedef struct HDC1080_SIM_DEVICE_CONFIG {
+  unsigned char i2c_address;
+  unsigned char mux_address;
+  unsigned char mux_channel;
+  uint64_t serial_id;
+  unsigned int conversion_scale;
+} hdc1080_sim_device_config_t;
+
+/* BUS TRAFFIC COUNTERS
+ * transactions -> TRANSACTIONS ADDRESSED TO ANYTHING ON THE BUS
+ * nacks -> TRANSACTIONS THAT ENDED IN A NACK
+ * timeouts -> TRANSACTIONS THAT TIMED OUT
+ * bytes_written/bytes_read -> DATA BYTES, ADDRESS BYTES NOT INCLUDED
+ * conversions -> MEASUREMENT CONVERSIONS STARTED
+ * mux_switches -> WRITES TO A MUX CONTROL REGISTER
+ * bus_time -> MICROSECONDS THE TRAFFIC WOULD OCCUPY THE BUS AT bus_frequency */
+typedef struct HDC1080_SIM_STATS {
+  uint32_t transactions;
+  uint32_t nacks;
+  uint32_t timeouts;
+  uint32_t bytes_written;
+  uint32_t bytes_read;
+  uint32_t conversions;
+  uint32_t mux_switches;
+  uint64_t bus_time;
+} hdc1080_sim_stats_t;
+
+typedef struct hdc1080_sim_bus_t * hdc1080_sim_handle_t;
+
+esp_err_t hdc1080_sim_create(uint32_t bus_frequency, hdc1080_sim_handle_t * sim_handle);
+esp_err_t hdc1080_sim_delete(hdc1080_sim_handle_t sim_handle);
+void hdc1080_sim_get_bus(hdc1080_sim_handle_t sim_handle, hdc1080_bus_t * bus);
+esp_err_t hdc1080_sim_add_mux(hdc1080_sim_handle_t sim_handle, unsigned char mux_address);
+esp_err_t hdc1080_sim_add_device(hdc1080_sim_handle_t sim_handle, const hdc1080_sim_device_config_t * device_config, int * device_id);
+esp_err_t hdc1080_sim_set_environment(hdc1080_sim_handle_t sim_handle, int device_id, float celsius, float humidity);
+esp_err_t hdc1080_sim_set_source(hdc1080_sim_handle_t sim_handle, int device_id, hdc1080_sim_source_t source, void * source_ctx);
+esp_err_t hdc1080_sim_inject_fault(hdc1080_sim_handle_t sim_handle, int device_id, hdc1080_sim_fault_t fault, uint32_t count);
+void hdc1080_sim_get_stats(hdc1080_sim_handle_t sim_handle, hdc1080_sim_stats_t * stats);
+void hdc1080_sim_reset_stats(hdc1080_sim_handle_t sim_handle);
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * ESP32 HDC1080 COMPONENT DRIVER LIBRARY
+ * Copyright 2023 Open grStat
+ *
+ * SPDX-FileCopyrightText: 2023 Open grStat https://github.com/grstat
+ * SPDX-FileType: HEADER
+ * SPDX-FileContributor: Created by Adrian Borchardt
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ */
+#ifndef __HDC1080_STREAM_H__
+#define __HDC1080_STREAM_H__
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* COMPACT FRAMED STREAM OF RAW SAMPLES FOR SHIPPING SENSOR HISTORY. THIS
+ * HEADER AND hdc1080_stream.c ONLY NEED A C99 COMPILER SO THE DECODER
+ * BUILDS ON A HOST AS IS. NOTHING TOUCHES THE HEAP, THE ENCODER WRITES
+ * INTO AND THE DECODER READS FROM CALLER PROVIDED BUFFERS
+ *
+ * FRAME, MULTI BYTE HEADER FIELDS ARE LITTLE ENDIAN
+ * 0      SYNC, HDC1080_STREAM_SYNC
+ * 1      VERSION, HDC1080_STREAM_VERSION
+ * 2      CONFIG REGISTER, GIVES THE RESOLUTION OF THE CODES
+ * 3-8    SENSOR ID, THE 41 BIT SERIAL FROM THE SERIALID REGISTERS
+ * 9-10   PAYLOAD LENGTH IN BYTES
+ * 11-12  SAMPLE COUNT
+ * 13-    PAYLOAD
+ * LAST 2 CRC-16/CCITT-FALSE OF EVERYTHING BEFORE IT
+ *
+ * PAYLOAD, THE CODES ARE STORED AT THE CONFIGURED RESOLUTION, THE LOW
+ * BITS THE HDC1080 ALWAYS RETURNS AS 0 ARE DROPPED
+ * FIRST SAMPLE -> VARINT TIMESTAMP, VARINT TEMPERATURE, VARINT HUMIDITY
+ * EVERY OTHER -> ZIGZAG VARINT CHANGE OF THE TIMESTAMP DELTA, ZIGZAG
+ *                VARINT TEMPERATURE DELTA, ZIGZAG VARINT HUMIDITY DELTA
+ * WITH HDC1080_STREAM_FRAME_SAMPLES PER FRAME A STEADY SAMPLE PERIOD AND A
+ * STEADY ROOM COST ABOUT 3.1 BYTES PER SAMPLE, 3 FOR THE SAMPLE AND THE
+ * REST FOR THE FRAME. +-100uS OF TIMING JITTER RAISES IT TO ABOUT 3.5 */
+
+#define HDC1080_STREAM_SYNC             0xA5
+#define HDC1080_STREAM_VERSION          0x01
+#define HDC1080_STREAM_HEADER_LEN       (13)
+#define HDC1080_STREAM_CRC_LEN          (2)
+#define HDC1080_STREAM_MAX_SAMPLE_LEN   (16)    /* WORST CASE ENCODED SAMPLE */
+#define HDC1080_STREAM_FRAME_SAMPLES    (256)   /* SAMPLES PER FRAME WHEN frame_samples IS 0 */
+
+/* hdc1080_stream_decode RESULTS */
+#define HDC1080_STREAM_OK         (0)   /* sample HOLDS THE NEXT SAMPLE */
+#define HDC1080_STREAM_END        (1)   /* EVERYTHING HAS BEEN DECODED */
+#define HDC1080_STREAM_TRUNCATED  (2)   /* THE DATA ENDS INSIDE A FRAME, offset POINTS AT ITS START */
+#define HDC1080_STREAM_CORRUPT    (3)   /* A BAD FRAME WAS SKIPPED, DECODING CAN GO ON */
+
+/* ONE SAMPLE AS ENCODED AND DECODED
+ * timestamp -> MICROSECONDS, e.g. esp_timer_get_time()
+ * temperature/humidity -> THE RAW 16 BIT CODES */
+typedef struct HDC1080_STREAM_SAMPLE {
+  int64_t timestamp;
+  uint16_t temperature;
+  uint16_t humidity;
+} hdc1080_stream_sample_t;
+
+/* ENCODER STATE, SET UP WITH hdc1080_stream_encoder_init
+ * buffer/capacity/length -> THE CALLER BUFFER AND HOW MUCH OF IT IS USED
+ * sensor_id/config_register -> WRITTEN INTO EVERY FRAME HEADER
+ * frame_samples -> SAMPLES AFTER WHICH A FRAME IS CLOSED
+ * frame_start -> OFFSET OF THE OPEN FRAME, frame_open SAYS IF THERE IS ONE
+ * frame_count -> SAMPLES IN THE OPEN FRAME
+ * last -> PREVIOUS SAMPLE, CODES ALREADY SHIFTED DOWN
+ * last_delta -> PREVIOUS TIMESTAMP DELTA */
+typedef struct HDC1080_STREAM_ENCODER {
+  uint8_t * buffer;
+  size_t capacity;
+  size_t length;
+  uint64_t sensor_id;
+  uint8_t config_register;
+  uint16_t frame_samples;
+  size_t frame_start;
+  bool frame_open;
+  uint16_t frame_count;
+  hdc1080_stream_sample_t last;
+  int64_t last_delta;
+} hdc1080_stream_encoder_t;
+
+/* DECODER STATE, SET UP WITH hdc1080_stream_decoder_init
+ * data/length -> THE BYTES TO DECODE
+ * offset -> START OF THE NEXT FRAME, AFTER HDC1080_STREAM_TRUNCATED
+ *           EVERYTHING FROM HERE ON HAS TO BE KEPT AND DECODED AGAIN
+ *           WITH THE REST OF THE DATA APPENDED
+ * position/frame_end -> READ POSITION AND END OF THE PAYLOAD OF THE CURRENT FRAME
+ * frame_remaining/frame_total -> SAMPLES LEFT IN AND SAMPLES IN THE CURRENT
+ *                                FRAME, frame_remaining IS 0 BETWEEN FRAMES
+ * sensor_id/config_register -> FROM THE CURRENT FRAME HEADER
+ * last/last_delta -> SAME AS THE ENCODER */
+typedef struct HDC1080_STREAM_DECODER {
+  const uint8_t * data;
+  size_t length;
+  size_t offset;
+  size_t position;
+  size_t frame_end;
+  uint16_t frame_remaining;
+  uint16_t frame_total;
+  uint64_t sensor_id;
+  uint8_t config_register;
+  hdc1080_stream_sample_t last;
+  int64_t last_delta;
+} hdc1080_stream_decoder_t;
+
+void hdc1080_stream_encoder_init(hdc1080_stream_encoder_t * encoder, uint8_t * buffer, size_t capacity, uint64_t sensor_id, uint8_t config_register, uint16_t frame_samples);
+bool hdc1080_stream_put(hdc1080_stream_encoder_t * encoder, const hdc1080_stream_sample_t * sample);
+size_t hdc1080_stream_encode(hdc1080_stream_encoder_t * encoder, const hdc1080_stream_sample_t * samples, size_t count);
+size_t hdc1080_stream_finish(hdc1080_stream_encoder_t * encoder);
+void hdc1080_stream_encoder_clear(hdc1080_stream_encoder_t * encoder);
+void hdc1080_stream_decoder_init(hdc1080_stream_decoder_t * decoder, const uint8_t * data, size_t length);
+int hdc1080_stream_decode(hdc1080_stream_decoder_t * decoder, hdc1080_stream_sample_t * sample);
+
+#endif
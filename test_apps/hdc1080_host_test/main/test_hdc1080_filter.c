@@ -0,0 +1,189 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "unity.h"
+#include "hdc1080.h"
+#include "hdc1080_sim.h"
+
+#define TEST_TIMEOUT            ((TickType_t)200 / portTICK_PERIOD_MS)
+#define TEST_PERIOD             (20000)   /* MICROSECONDS BETWEEN CONTINUOUS SAMPLING SLOTS */
+#define TEST_CODE               (25818)   /* ABOUT 25°C AS A TEMPERATURE CODE */
+#define TEST_CENTI_CODES        (4)       /* ONE CENTI-DEGREE IS JUST UNDER 4 TEMPERATURE CODES */
+
+/* PUSH ONE PAIR OF CODES THROUGH THE FILTER, raw COMES BACK FILTERED */
+static unsigned char test_push(const hdc1080_filter_t * filter, hdc1080_filter_state_t * state, unsigned short temperature, unsigned short humidity, int64_t now, hdc1080_raw_readings_t * raw){
+  raw->temperature = temperature;
+  raw->humidity = humidity;
+  return hdc1080_filter_push(filter, state, HDC1080_CHANNEL_BOTH, raw, now);
+}
+
+TEST_CASE("filter settings are range checked", "[hdc1080][filter]"){
+  hdc1080_filter_t filter = {0};
+  TEST_ASSERT_TRUE(hdc1080_filter_valid(&filter));
+  TEST_ASSERT_FALSE(hdc1080_filter_valid(NULL));
+  filter.oversample = HDC1080_FILTER_MAX_OVERSAMPLE;
+  filter.decimation = HDC1080_DECIMATE_MEDIAN;
+  filter.ema_shift = HDC1080_FILTER_MAX_EMA_SHIFT;
+  TEST_ASSERT_TRUE(hdc1080_filter_valid(&filter));
+  filter.oversample = HDC1080_FILTER_MAX_OVERSAMPLE + 1;
+  TEST_ASSERT_FALSE(hdc1080_filter_valid(&filter));
+  filter.oversample = 0;
+  filter.decimation = HDC1080_DECIMATE_MEDIAN + 1;
+  TEST_ASSERT_FALSE(hdc1080_filter_valid(&filter));
+  filter.decimation = HDC1080_DECIMATE_MEAN;
+  filter.ema_shift = HDC1080_FILTER_MAX_EMA_SHIFT + 1;
+  TEST_ASSERT_FALSE(hdc1080_filter_valid(&filter));
+}
+
+TEST_CASE("filter decimates by the mean or the median", "[hdc1080][filter]"){
+  hdc1080_filter_t filter = { .oversample = 4, .decimation = HDC1080_DECIMATE_MEAN };
+  hdc1080_filter_state_t state;
+  hdc1080_filter_reset(&state);
+  hdc1080_raw_readings_t raw;
+  const unsigned short mean_codes[] = { 1000, 1004, 1008, 1022 };
+  for(int round = 0; round < 2; round++){
+    for(int i = 0; i < 3; i++){
+      TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_DECIMATED, test_push(&filter, &state, mean_codes[i], mean_codes[i] + 100, 0, &raw));
+    }
+    TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_PASS, test_push(&filter, &state, mean_codes[3], mean_codes[3] + 100, 0, &raw));
+    // 4034 / 4 ROUNDS UP
+    TEST_ASSERT_EQUAL_UINT16(1009, raw.temperature);
+    TEST_ASSERT_EQUAL_UINT16(1109, raw.humidity);
+  }
+  // THE MEDIAN SHRUGS OFF ONE WILD CODE
+  filter = (hdc1080_filter_t){ .oversample = 5, .decimation = HDC1080_DECIMATE_MEDIAN };
+  hdc1080_filter_reset(&state);
+  const unsigned short median_codes[] = { 1000, 1004, 60000, 1008, 1002 };
+  for(int i = 0; i < 4; i++){
+    TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_DECIMATED, test_push(&filter, &state, median_codes[i], median_codes[4 - i], 0, &raw));
+  }
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_PASS, test_push(&filter, &state, median_codes[4], median_codes[0], 0, &raw));
+  TEST_ASSERT_EQUAL_UINT16(1004, raw.temperature);
+  TEST_ASSERT_EQUAL_UINT16(1004, raw.humidity);
+  // AN EVEN WINDOW TAKES THE ROUNDED MEAN OF THE MIDDLE TWO
+  filter.oversample = 4;
+  hdc1080_filter_reset(&state);
+  for(int i = 0; i < 3; i++){ test_push(&filter, &state, median_codes[i], median_codes[i], 0, &raw); }
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_PASS, test_push(&filter, &state, median_codes[3], median_codes[3], 0, &raw));
+  TEST_ASSERT_EQUAL_UINT16(1006, raw.temperature);
+}
+
+TEST_CASE("filter ema is seeded by the first code and converges", "[hdc1080][filter]"){
+  hdc1080_filter_t filter = { .ema_shift = 2 };
+  hdc1080_filter_state_t state;
+  hdc1080_filter_reset(&state);
+  hdc1080_raw_readings_t raw;
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_PASS, test_push(&filter, &state, 10000, 40000, 0, &raw));
+  TEST_ASSERT_EQUAL_UINT16(10000, raw.temperature);
+  TEST_ASSERT_EQUAL_UINT16(40000, raw.humidity);
+  // A QUARTER OF THE STEP EACH TIME
+  test_push(&filter, &state, 20000, 20000, 0, &raw);
+  TEST_ASSERT_EQUAL_UINT16(12500, raw.temperature);
+  TEST_ASSERT_EQUAL_UINT16(35000, raw.humidity);
+  unsigned short last = raw.temperature;
+  for(int i = 0; i < 40; i++){
+    test_push(&filter, &state, 20000, 20000, 0, &raw);
+    TEST_ASSERT_GREATER_OR_EQUAL(last, raw.temperature);
+    last = raw.temperature;
+  }
+  TEST_ASSERT_UINT16_WITHIN(1, 20000, raw.temperature);
+  TEST_ASSERT_UINT16_WITHIN(1, 20000, raw.humidity);
+  // A RESET SEEDS AGAIN
+  hdc1080_filter_reset(&state);
+  test_push(&filter, &state, 5000, 5000, 0, &raw);
+  TEST_ASSERT_EQUAL_UINT16(5000, raw.temperature);
+}
+
+TEST_CASE("filter deadband holds back small moves until max_silence", "[hdc1080][filter]"){
+  hdc1080_filter_t filter = { .temperature_deadband = 50, .max_silence = 1000000 };
+  hdc1080_filter_state_t state;
+  hdc1080_filter_reset(&state);
+  hdc1080_raw_readings_t raw;
+  // THE FIRST RESULT ALWAYS GOES OUT
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_PASS, test_push(&filter, &state, TEST_CODE, TEST_CODE, 0, &raw));
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_SUPPRESSED, test_push(&filter, &state, TEST_CODE + (40 * TEST_CENTI_CODES), TEST_CODE, 100000, &raw));
+  // HUMIDITY HAS NO DEADBAND, IT NEVER TRIGGERS
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_SUPPRESSED, test_push(&filter, &state, TEST_CODE, TEST_CODE + 10000, 200000, &raw));
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_PASS, test_push(&filter, &state, TEST_CODE + (52 * TEST_CENTI_CODES), TEST_CODE, 300000, &raw));
+  TEST_ASSERT_EQUAL_UINT16(TEST_CODE + (52 * TEST_CENTI_CODES), raw.temperature);
+  // THE DEADBAND IS AGAINST THE LAST RESULT PASSED ON, DOWN WORKS THE SAME
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_SUPPRESSED, test_push(&filter, &state, TEST_CODE + (10 * TEST_CENTI_CODES), TEST_CODE, 400000, &raw));
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_PASS, test_push(&filter, &state, TEST_CODE - (2 * TEST_CENTI_CODES), TEST_CODE, 500000, &raw));
+  // NOTHING MOVED FOR max_silence
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_SUPPRESSED, test_push(&filter, &state, TEST_CODE - (2 * TEST_CENTI_CODES), TEST_CODE, 1499999, &raw));
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_PASS, test_push(&filter, &state, TEST_CODE - (2 * TEST_CENTI_CODES), TEST_CODE, 1500000, &raw));
+  // A HUMIDITY ONLY CONVERSION IGNORES THE TEMPERATURE DEADBAND
+  raw = (hdc1080_raw_readings_t){ .temperature = 0, .humidity = TEST_CODE };
+  TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_SUPPRESSED, hdc1080_filter_push(&filter, &state, HDC1080_CHANNEL_HUMIDITY, &raw, 1600000));
+  // BOTH DEADBANDS AT 0 PASSES EVERYTHING ON
+  filter = (hdc1080_filter_t){0};
+  for(int i = 0; i < 4; i++){
+    TEST_ASSERT_EQUAL_UINT8(HDC1080_FILTER_PASS, test_push(&filter, &state, TEST_CODE, TEST_CODE, 1700000, &raw));
+  }
+}
+
+TEST_CASE("driver filters the continuous sampling ring", "[hdc1080][filter][sim]"){
+  hdc1080_sim_handle_t sim = NULL;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_create(400000, &sim));
+  hdc1080_sim_device_config_t device_config = { .i2c_address = HDC1080_I2C_ADDRESS };
+  int device_id = 0;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_add_device(sim, &device_config, &device_id));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_set_environment(sim, device_id, 25.0f, 40.0f));
+  hdc1080_settings_t settings = {
+    .i2c_address = HDC1080_I2C_ADDRESS,
+    .timeout_length = TEST_TIMEOUT,
+    .sample_buffer_length = 32,
+    .filter = {
+      .oversample = 3,
+      .decimation = HDC1080_DECIMATE_MEDIAN,
+      .temperature_deadband = 50,
+      .humidity_deadband = 100
+    }
+  };
+  hdc1080_sim_get_bus(sim, &settings.bus);
+  hdc1080_config_t config = { .mode_of_acquisition = HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE };
+  hdc1080_handle_t hdc_handle = NULL;
+  // OUT OF RANGE SETTINGS ARE REFUSED UP FRONT
+  settings.filter.ema_shift = HDC1080_FILTER_MAX_EMA_SHIFT + 1;
+  TEST_ASSERT_EQUAL_HEX(ESP_ERR_INVALID_ARG, hdc1080_configure(&settings, config, &hdc_handle));
+  settings.filter.ema_shift = 0;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&settings, config, &hdc_handle));
+  // A STEADY ROOM, ONE RESULT AND THEN NOTHING
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_start_continuous(hdc_handle, TEST_PERIOD));
+  vTaskDelay(pdMS_TO_TICKS(TEST_PERIOD * 15 / 1000));
+  // A STEP PAST THE DEADBAND COMES THROUGH ONCE THE MEDIAN TAKES IT
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_set_environment(sim, device_id, 27.0f, 40.0f));
+  vTaskDelay(pdMS_TO_TICKS(TEST_PERIOD * 15 / 1000));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_stop_continuous(hdc_handle));
+  // LET THE LAST CONVERSION LAND
+  vTaskDelay(pdMS_TO_TICKS(50));
+  hdc1080_sample_t samples[32];
+  size_t count = hdc1080_drain_samples(hdc_handle, samples, 32);
+  TEST_ASSERT_EQUAL_size_t(2, count);
+  TEST_ASSERT_INT_WITHIN(2, 2500, hdc1080_temperature_centi(samples[0].raw.temperature));
+  TEST_ASSERT_INT_WITHIN(2, 2700, hdc1080_temperature_centi(samples[1].raw.temperature));
+  // EVERY CONVERSION WAS EITHER PASSED ON OR COUNTED AS HELD BACK, BUT
+  // ONE THAT LANDS AFTER THE STOP IS NO LONGER CONTINUOUS AND SKIPS THE FILTER
+  hdc1080_stats_t stats;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_stats(hdc_handle, &stats));
+  TEST_ASSERT_GREATER_OR_EQUAL(20, stats.conversions_completed);
+  TEST_ASSERT_GREATER_THAN(0, stats.suppressed);
+  TEST_ASSERT_LESS_OR_EQUAL(stats.conversions_completed, stats.decimated + stats.suppressed + count);
+  TEST_ASSERT_GREATER_OR_EQUAL(stats.conversions_completed - 1, stats.decimated + stats.suppressed + count);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.samples_dropped);
+  // A NEW FILTER STARTS OVER, ALL 0 PASSES EVERY CONVERSION
+  hdc1080_filter_t filter = {0};
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_set_filter(hdc_handle, &filter));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_reset_stats(hdc_handle));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_start_continuous(hdc_handle, TEST_PERIOD));
+  vTaskDelay(pdMS_TO_TICKS(TEST_PERIOD * 10 / 1000));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_stop_continuous(hdc_handle));
+  vTaskDelay(pdMS_TO_TICKS(50));
+  count = hdc1080_drain_samples(hdc_handle, samples, 32);
+  TEST_ASSERT_GREATER_OR_EQUAL(6, count);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_stats(hdc_handle, &stats));
+  TEST_ASSERT_EQUAL_UINT32(0, stats.decimated + stats.suppressed);
+  TEST_ASSERT_LESS_OR_EQUAL(stats.conversions_completed, count);
+  TEST_ASSERT_GREATER_OR_EQUAL(stats.conversions_completed - 1, count);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+  hdc1080_sim_delete(sim);
+}
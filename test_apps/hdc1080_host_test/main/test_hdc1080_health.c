@@ -0,0 +1,175 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "unity.h"
+#include "hdc1080.h"
+#include "hdc1080_sim.h"
+
+#define TEST_TIMEOUT            ((TickType_t)100 / portTICK_PERIOD_MS)
+#define TEST_PERIOD             (20000)   /* MICROSECONDS BETWEEN CONTINUOUS SAMPLING SLOTS */
+#define TEST_THRESHOLD          (3)
+#define TEST_BACKOFF_MIN        (20000)
+#define TEST_BACKOFF_MAX        (200000)
+#define TEST_CALLS              (100)
+#define TEST_CALL_INTERVAL_MS   (5)
+
+/* ONE SIMULATED HDC1080 WITH HEALTH TRACKING AND A CONFIG THAT IS NOT THE RESET DEFAULT */
+static void test_health_create(hdc1080_sim_handle_t * sim, int * device_id, hdc1080_settings_t * settings, hdc1080_config_t * config){
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_create(400000, sim));
+  hdc1080_sim_device_config_t device_config = { .i2c_address = HDC1080_I2C_ADDRESS };
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_add_device(*sim, &device_config, device_id));
+  *settings = (hdc1080_settings_t){
+    .i2c_address = HDC1080_I2C_ADDRESS,
+    .timeout_length = TEST_TIMEOUT,
+    .health = {
+      .failure_threshold = TEST_THRESHOLD,
+      .backoff_min = TEST_BACKOFF_MIN,
+      .backoff_max = TEST_BACKOFF_MAX
+    }
+  };
+  hdc1080_sim_get_bus(*sim, &settings->bus);
+  *config = (hdc1080_config_t){0};
+  config->mode_of_acquisition = HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE;
+  config->heater = HDC1080_HEATER_ENABLED;
+  config->humidity_measurement_resolution = HDC1080_HUMIDITY_RESOLUTION_11BIT;
+}
+
+TEST_CASE("a failing sensor backs off, goes down and recovers", "[hdc1080][health][sim]"){
+  hdc1080_sim_handle_t sim = NULL;
+  int device_id = 0;
+  hdc1080_settings_t settings;
+  hdc1080_config_t config;
+  test_health_create(&sim, &device_id, &settings, &config);
+  hdc1080_handle_t hdc_handle = NULL;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&settings, config, &hdc_handle));
+  hdc1080_sim_inject_fault(sim, device_id, HDC1080_SIM_FAULT_NACK, HDC1080_SIM_FAULT_FOREVER);
+  hdc1080_sim_reset_stats(sim);
+  hdc1080_sensor_readings_t sens_readings = {0};
+  int fast_failed = 0;
+  for(int i = 0; i < TEST_CALLS; i++){
+    esp_err_t err_ck = hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT);
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, err_ck);
+    if(err_ck == HDC1080_ERR_DOWN){ fast_failed++; }
+    vTaskDelay(pdMS_TO_TICKS(TEST_CALL_INTERVAL_MS));
+  }
+  // THE BACKOFF KEEPS MOST CALLS OFF THE BUS
+  hdc1080_sim_stats_t sim_stats;
+  hdc1080_sim_get_stats(sim, &sim_stats);
+  TEST_ASSERT_GREATER_THAN(TEST_CALLS / 2, fast_failed);
+  TEST_ASSERT_LESS_THAN(TEST_CALLS / 4, sim_stats.nacks);
+  hdc1080_stats_t stats;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_stats(hdc_handle, &stats));
+  TEST_ASSERT_EQUAL_UINT32(fast_failed, stats.fast_failed);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.recoveries);
+  hdc1080_health_state_t health;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_health(hdc_handle, &health));
+  TEST_ASSERT_TRUE(health.down);
+  TEST_ASSERT_GREATER_OR_EQUAL(TEST_THRESHOLD, health.failures);
+  TEST_ASSERT_GREATER_THAN(0, health.retry_at);
+  // ONCE THE FAULT IS GONE THE FIRST CALL AFTER THE BACKOFF RECOVERS IT
+  hdc1080_sim_inject_fault(sim, device_id, HDC1080_SIM_FAULT_NONE, 0);
+  vTaskDelay(pdMS_TO_TICKS((TEST_BACKOFF_MAX / 1000) + 50));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_stats(hdc_handle, &stats));
+  TEST_ASSERT_EQUAL_UINT32(1, stats.recoveries);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_health(hdc_handle, &health));
+  TEST_ASSERT_FALSE(health.down);
+  TEST_ASSERT_EQUAL_UINT(0, health.failures);
+  TEST_ASSERT_EQUAL_INT64(0, health.retry_at);
+  // THE SOFT RESET CLEARED THE CONFIG, THE RECOVERY WROTE IT BACK
+  hdc1080_config_t read_back = {0};
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_configuration(hdc_handle, &read_back));
+  TEST_ASSERT_EQUAL_HEX8(config.config_register, read_back.config_register);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+  // HEALTH TRACKING OFF, EVERY CALL GOES TO THE BUS
+  settings.health.failure_threshold = 0;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&settings, config, &hdc_handle));
+  hdc1080_sim_inject_fault(sim, device_id, HDC1080_SIM_FAULT_NACK, HDC1080_SIM_FAULT_FOREVER);
+  hdc1080_sim_reset_stats(sim);
+  for(int i = 0; i < 10; i++){
+    TEST_ASSERT_EQUAL_HEX(ESP_FAIL, hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT));
+  }
+  hdc1080_sim_get_stats(sim, &sim_stats);
+  TEST_ASSERT_GREATER_OR_EQUAL(10, sim_stats.nacks);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_stats(hdc_handle, &stats));
+  TEST_ASSERT_EQUAL_UINT32(0, stats.fast_failed);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+  hdc1080_sim_delete(sim);
+}
+
+TEST_CASE("a stuck bus is cleared by the recovery", "[hdc1080][health][sim]"){
+  hdc1080_sim_handle_t sim = NULL;
+  int device_id = 0;
+  hdc1080_settings_t settings;
+  hdc1080_config_t config;
+  test_health_create(&sim, &device_id, &settings, &config);
+  hdc1080_handle_t hdc_handle = NULL;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&settings, config, &hdc_handle));
+  hdc1080_sim_inject_fault(sim, -1, HDC1080_SIM_FAULT_TIMEOUT, HDC1080_SIM_FAULT_FOREVER);
+  hdc1080_sensor_readings_t sens_readings = {0};
+  hdc1080_health_state_t health = {0};
+  // ONLY THE BUS CLEAR OF A RECOVERY RELEASES IT
+  for(int i = 0; i < 50 && !health.down; i++){
+    hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT);
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_health(hdc_handle, &health));
+    vTaskDelay(pdMS_TO_TICKS(TEST_BACKOFF_MIN / 1000));
+  }
+  TEST_ASSERT_TRUE(health.down);
+  vTaskDelay(pdMS_TO_TICKS((TEST_BACKOFF_MAX / 1000) + 50));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT));
+  hdc1080_stats_t stats;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_stats(hdc_handle, &stats));
+  TEST_ASSERT_EQUAL_UINT32(1, stats.recoveries);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+  hdc1080_sim_delete(sim);
+}
+
+TEST_CASE("continuous sampling recovers in its worker or through hdc1080_recover", "[hdc1080][health][sim]"){
+  hdc1080_sim_handle_t sim = NULL;
+  int device_id = 0;
+  hdc1080_settings_t settings;
+  hdc1080_config_t config;
+  test_health_create(&sim, &device_id, &settings, &config);
+  settings.sample_buffer_length = 64;
+  for(int worker = 0; worker < 2; worker++){
+    // WITHOUT use_worker_task hdc1080_start_continuous STARTS THE WORKER ITSELF
+    settings.use_worker_task = (worker == 1);
+    hdc1080_handle_t hdc_handle = NULL;
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&settings, config, &hdc_handle));
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_start_continuous(hdc_handle, TEST_PERIOD));
+    hdc1080_sim_inject_fault(sim, device_id, HDC1080_SIM_FAULT_NACK, HDC1080_SIM_FAULT_FOREVER);
+    vTaskDelay(pdMS_TO_TICKS(300));
+    hdc1080_health_state_t health;
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_health(hdc_handle, &health));
+    TEST_ASSERT_TRUE(health.down);
+    hdc1080_sim_inject_fault(sim, device_id, HDC1080_SIM_FAULT_NONE, 0);
+    hdc1080_sample_t samples[64];
+    hdc1080_drain_samples(hdc_handle, samples, 64);
+    if(worker == 1){
+      // hdc1080_recover DOES NOT WAIT OUT THE BACKOFF
+      esp_err_t err_ck = HDC1080_CONVERTING;
+      for(int i = 0; i < 100 && err_ck == HDC1080_CONVERTING; i++){
+        err_ck = hdc1080_recover(hdc_handle);
+        if(err_ck == HDC1080_CONVERTING){ vTaskDelay(pdMS_TO_TICKS(1)); }
+      }
+      TEST_ASSERT_EQUAL_HEX(ESP_OK, err_ck);
+      vTaskDelay(pdMS_TO_TICKS(TEST_PERIOD * 5 / 1000));
+    }else{
+      vTaskDelay(pdMS_TO_TICKS((TEST_BACKOFF_MAX / 1000) + 100));
+    }
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_health(hdc_handle, &health));
+    TEST_ASSERT_FALSE(health.down);
+    hdc1080_stats_t stats;
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_stats(hdc_handle, &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.recoveries);
+    // SAMPLES FLOW AGAIN
+    TEST_ASSERT_GREATER_THAN(0, hdc1080_drain_samples(hdc_handle, samples, 64));
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_stop_continuous(hdc_handle));
+    esp_err_t err_ck = HDC1080_CONVERTING;
+    for(int i = 0; i < 100 && err_ck == HDC1080_CONVERTING; i++){
+      err_ck = hdc1080_delete(hdc_handle);
+      if(err_ck == HDC1080_CONVERTING){ vTaskDelay(pdMS_TO_TICKS(1)); }
+    }
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, err_ck);
+  }
+  hdc1080_sim_delete(sim);
+}
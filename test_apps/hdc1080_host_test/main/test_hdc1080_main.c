@@ -0,0 +1,10 @@
+#include <stdlib.h>
+#include "unity.h"
+
+/* RUN EVERY TEST_CASE LINKED INTO THE APP, THE EXIT CODE IS THE
+ * NUMBER OF FAILURES SO A CI JOB CAN TELL A FAILED RUN */
+void app_main(void){
+  UNITY_BEGIN();
+  unity_run_all_tests();
+  exit(UNITY_END());
+}
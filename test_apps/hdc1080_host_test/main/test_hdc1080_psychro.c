@@ -0,0 +1,84 @@
+#include <math.h>
+#include "unity.h"
+#include "hdc1080.h"
+
+/* THE SWEEP COVERS THE WHOLE HDC1080 RANGE, SEE THE BOUNDS IN hdc1080_psychro.h */
+#define TEST_CELSIUS_MIN        (-40.0)
+#define TEST_CELSIUS_MAX        (125.0)
+#define TEST_CELSIUS_STEP       (0.25)
+#define TEST_HUMIDITY_STEP      (0.5)
+#define TEST_CENTI_CELSIUS_STEP (7)     /* ODD STEPS SO THE FIXED SWEEP HITS EVERY TABLE OFFSET */
+#define TEST_CENTI_HUMIDITY_STEP (13)
+
+/* DOUBLE PRECISION REFERENCE, THE FORMULAS OF THE OLD MACROS */
+static double test_dewpoint_reference(double celsius, double humidity){
+  double dryness = 1.0 - (humidity / 100.0);
+  return celsius - ((14.55 + 0.114 * celsius) * dryness)
+                 - pow((2.5 + 0.007 * celsius) * dryness, 3)
+                 - ((15.9 + 0.117 * celsius) * pow(dryness, 14));
+}
+
+static double test_svp_reference(double celsius){
+  return 610.78 * exp((17.2694 * celsius) / (celsius + 237.3));
+}
+
+static double test_vpd_reference(double svp, double humidity){
+  return (svp * (1.0 - (humidity / 100.0))) / 1000.0;
+}
+
+TEST_CASE("float dewpoint, svp and vpd stay within their bounds", "[hdc1080][psychro]"){
+  for(double celsius = TEST_CELSIUS_MIN; celsius <= TEST_CELSIUS_MAX; celsius += TEST_CELSIUS_STEP){
+    double svp_reference = test_svp_reference(celsius);
+    float svp = hdc1080_svp((float)celsius);
+    // 0.0005% RELATIVE
+    TEST_ASSERT_DOUBLE_WITHIN(svp_reference * 0.000005, svp_reference, svp);
+    for(double humidity = 0.0; humidity <= 100.0; humidity += TEST_HUMIDITY_STEP){
+      TEST_ASSERT_DOUBLE_WITHIN(0.001, test_dewpoint_reference(celsius, humidity), hdc1080_dewpoint((float)celsius, (float)humidity));
+      // THE SVP ERROR CARRIES OVER, THE REST IS SINGLE PRECISION ROUNDING
+      double vpd_reference = test_vpd_reference(svp_reference, humidity);
+      TEST_ASSERT_DOUBLE_WITHIN((vpd_reference * 0.000005) + 0.000002, vpd_reference, hdc1080_vpd(svp, (float)humidity));
+    }
+  }
+}
+
+TEST_CASE("fixed point dewpoint, svp and vpd stay within their bounds", "[hdc1080][psychro]"){
+  for(int centi_celsius = -4000; centi_celsius <= 12500; centi_celsius += TEST_CENTI_CELSIUS_STEP){
+    double celsius = centi_celsius / 100.0;
+    double svp_reference = test_svp_reference(celsius);
+    uint32_t svp = hdc1080_svp_fixed((int16_t)centi_celsius);
+    // 0.15% RELATIVE PLUS 0.5Pa ROUNDING
+    TEST_ASSERT_DOUBLE_WITHIN((svp_reference * 0.0015) + 0.5, svp_reference, svp);
+    for(int centi_humidity = 0; centi_humidity <= 10000; centi_humidity += TEST_CENTI_HUMIDITY_STEP){
+      double humidity = centi_humidity / 100.0;
+      TEST_ASSERT_DOUBLE_WITHIN(2.0, test_dewpoint_reference(celsius, humidity) * 100.0, hdc1080_dewpoint_fixed((int16_t)centi_celsius, (uint16_t)centi_humidity));
+      // THE SVP BOUND SCALED BY THE DRYNESS PLUS ANOTHER 0.5Pa ROUNDING
+      double vpd_reference = test_vpd_reference(svp_reference, humidity) * 1000.0;
+      TEST_ASSERT_DOUBLE_WITHIN((vpd_reference * 0.0015) + 1.0, vpd_reference, hdc1080_vpd_fixed(svp, (uint16_t)centi_humidity));
+    }
+  }
+}
+
+TEST_CASE("psychro batches match the single reading functions", "[hdc1080][psychro]"){
+  hdc1080_sensor_readings_t readings[64];
+  hdc1080_fixed_readings_t fixed_readings[64];
+  for(int i = 0; i < 64; i++){
+    readings[i].temperature = -40.0f + (i * 2.6f);
+    readings[i].humidity = i * 1.5f;
+    fixed_readings[i].temperature = (int16_t)(-4000 + (i * 260));
+    fixed_readings[i].humidity = (uint16_t)(i * 150);
+  }
+  hdc1080_psychro_t psychro[64];
+  hdc1080_psychro_fixed_t psychro_fixed[64];
+  hdc1080_psychro_batch(readings, psychro, 64);
+  hdc1080_psychro_batch_fixed(fixed_readings, psychro_fixed, 64);
+  for(int i = 0; i < 64; i++){
+    float svp = hdc1080_svp(readings[i].temperature);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, hdc1080_dewpoint(readings[i].temperature, readings[i].humidity), psychro[i].dewpoint);
+    TEST_ASSERT_FLOAT_WITHIN(svp * 0.000001f, svp, psychro[i].svp);
+    TEST_ASSERT_FLOAT_WITHIN(0.000001f, hdc1080_vpd(svp, readings[i].humidity), psychro[i].vpd);
+    uint32_t svp_fixed = hdc1080_svp_fixed(fixed_readings[i].temperature);
+    TEST_ASSERT_EQUAL_INT16(hdc1080_dewpoint_fixed(fixed_readings[i].temperature, fixed_readings[i].humidity), psychro_fixed[i].dewpoint);
+    TEST_ASSERT_EQUAL_UINT32(svp_fixed, psychro_fixed[i].svp);
+    TEST_ASSERT_EQUAL_UINT32(hdc1080_vpd_fixed(svp_fixed, fixed_readings[i].humidity), psychro_fixed[i].vpd);
+  }
+}
@@ -0,0 +1,176 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "unity.h"
+#include "hdc1080.h"
+#include "hdc1080_sched.h"
+#include "hdc1080_sim.h"
+
+#define TEST_TIMEOUT            ((TickType_t)100 / portTICK_PERIOD_MS)
+#define TEST_PORT               (0)
+#define TEST_MUX_A              (0x70)
+#define TEST_MUX_B              (0x71)
+#define TEST_SENSORS            (6)       /* FOUR ON MUX A, TWO ON MUX B */
+#define TEST_PERIOD             (40000)   /* MICROSECONDS BETWEEN CYCLE STARTS */
+#define TEST_RUN_MS             (400)
+
+/* WHAT THE CALLBACK SAW FOR EACH SENSOR, ONLY READ AFTER hdc1080_sched_stop */
+typedef struct TEST_SCHED_RESULTS {
+  int readings[TEST_SENSORS];
+  int errors[TEST_SENSORS];
+  esp_err_t last_error[TEST_SENSORS];
+  hdc1080_raw_readings_t last_raw[TEST_SENSORS];
+} test_sched_results_t;
+
+/* SCHEDULER CALLBACK, RUNS IN THE PORT TASK */
+static void test_sched_callback(int sensor_id, esp_err_t error, const hdc1080_sample_t * sample, void * user_ctx){
+  test_sched_results_t * results = (test_sched_results_t *)user_ctx;
+  if(sensor_id < 0 || sensor_id >= TEST_SENSORS){ return; }
+  results->last_error[sensor_id] = error;
+  if(error == ESP_OK){
+    results->readings[sensor_id]++;
+    results->last_raw[sensor_id] = sample->raw;
+  }else{
+    results->errors[sensor_id]++;
+  }
+}
+
+/* -------------------------------------------------------------
+ * @name static void test_sched_create(hdc1080_sim_handle_t * sim, hdc1080_sched_handle_t * sched, test_sched_results_t * results, unsigned int period, hdc1080_health_t health)
+ * -------------------------------------------------------------
+ * @brief Build a simulated port with two muxes, four HDC1080S behind
+ * the first and two behind the second, each seeing 20°C plus its index
+ * and add them to a new scheduler in an order the mux routes do not sort
+ * @param sim -> filled with the simulated bus
+ * @param sched -> filled with the scheduler
+ * @param results -> handed to the callback, cleared
+ * @param period -> scheduler period
+ * @param health -> health settings of every sensor
+ */
+static void test_sched_create(hdc1080_sim_handle_t * sim, hdc1080_sched_handle_t * sched, test_sched_results_t * results, unsigned int period, hdc1080_health_t health){
+  static const unsigned char routes[TEST_SENSORS][2] = {
+    { TEST_MUX_B, 1 }, { TEST_MUX_A, 2 }, { TEST_MUX_A, 0 }, { TEST_MUX_B, 0 }, { TEST_MUX_A, 3 }, { TEST_MUX_A, 1 }
+  };
+  *results = (test_sched_results_t){0};
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_create(400000, sim));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_add_mux(*sim, TEST_MUX_A));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_add_mux(*sim, TEST_MUX_B));
+  hdc1080_sched_settings_t sched_settings = {
+    .period = period,
+    .timeout_length = TEST_TIMEOUT,
+    .callback = test_sched_callback,
+    .user_ctx = results
+  };
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_create(&sched_settings, sched));
+  for(int i = 0; i < TEST_SENSORS; i++){
+    hdc1080_sim_device_config_t device_config = {
+      .i2c_address = HDC1080_I2C_ADDRESS,
+      .mux_address = routes[i][0],
+      .mux_channel = routes[i][1]
+    };
+    int device_id = 0;
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_add_device(*sim, &device_config, &device_id));
+    TEST_ASSERT_EQUAL_INT(i, device_id);
+    hdc1080_sim_set_environment(*sim, device_id, 20.0f + i, 50.0f);
+    hdc1080_sched_sensor_t sensor = {
+      .i2c_port_number = TEST_PORT,
+      .mux_address = routes[i][0],
+      .mux_channel = routes[i][1],
+      .i2c_address = HDC1080_I2C_ADDRESS,
+      .config.mode_of_acquisition = HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE,
+      .channel = HDC1080_CHANNEL_BOTH,
+      .completion_mode = HDC1080_COMPLETION_TIMED,
+      .health = health
+    };
+    hdc1080_sim_get_bus(*sim, &sensor.bus);
+    int sensor_id = -1;
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_add_sensor(*sched, &sensor, &sensor_id));
+    TEST_ASSERT_EQUAL_INT(i, sensor_id);
+  }
+}
+
+TEST_CASE("the scheduler overlaps conversions behind muxes and batches the route writes", "[hdc1080][sched][sim]"){
+  hdc1080_sim_handle_t sim = NULL;
+  hdc1080_sched_handle_t sched = NULL;
+  test_sched_results_t results;
+  test_sched_create(&sim, &sched, &results, TEST_PERIOD, (hdc1080_health_t){0});
+  // ADDING THE SENSORS ALREADY ROUTED TO EACH OF THEM
+  hdc1080_sched_stats_t added;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_get_stats(sched, TEST_PORT, &added));
+  hdc1080_sim_reset_stats(sim);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_start(sched));
+  vTaskDelay(pdMS_TO_TICKS(TEST_RUN_MS));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_stop(sched));
+  hdc1080_sched_stats_t stats;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_get_stats(sched, TEST_PORT, &stats));
+  hdc1080_sim_stats_t sim_stats;
+  hdc1080_sim_get_stats(sim, &sim_stats);
+  // A STOP LETS THE CYCLE IN PROGRESS FINISH, EVERY SENSOR IS READ ONCE PER CYCLE
+  TEST_ASSERT_GREATER_OR_EQUAL(TEST_RUN_MS * 1000 / TEST_PERIOD / 2, stats.cycles);
+  TEST_ASSERT_EQUAL_UINT32(TEST_SENSORS * stats.cycles, sim_stats.conversions);
+  for(int i = 0; i < TEST_SENSORS; i++){
+    TEST_ASSERT_EQUAL_INT(0, results.errors[i]);
+    TEST_ASSERT_EQUAL_INT(stats.cycles, results.readings[i]);
+    // EACH CALLBACK GOT THE SENSOR ON ITS OWN ROUTE
+    hdc1080_fixed_readings_t fixed;
+    hdc1080_raw_to_fixed(&results.last_raw[i], &fixed, 1);
+    TEST_ASSERT_INT_WITHIN(2, (20 + i) * 100, fixed.temperature);
+  }
+  // THE CONVERSIONS OVERLAP, A CYCLE TAKES FAR LESS THAN ONE CONVERSION PER SENSOR
+  hdc1080_config_t config = { .mode_of_acquisition = HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE };
+  TEST_ASSERT_LESS_THAN(2 * hdc1080_conversion_time(config), stats.cycle_time_max);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.overruns);
+  // SORTED ROUTES, PER CYCLE ONE WRITE PER CHANNEL ON THE START PASS AND ONE
+  // ON THE READ PASS, PLUS A DISCONNECT WHENEVER THE OTHER MUX TAKES OVER
+  TEST_ASSERT_EQUAL_UINT32(stats.mux_switches - added.mux_switches, sim_stats.mux_switches);
+  TEST_ASSERT_LESS_OR_EQUAL(2 * (TEST_SENSORS + 2) * stats.cycles, sim_stats.mux_switches);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_delete(sched));
+  hdc1080_sim_delete(sim);
+}
+
+TEST_CASE("a back to back port with every sensor down does not spin", "[hdc1080][sched][health][sim]"){
+  hdc1080_sim_handle_t sim = NULL;
+  hdc1080_sched_handle_t sched = NULL;
+  test_sched_results_t results;
+  hdc1080_health_t health = { .failure_threshold = 2, .backoff_min = 50000, .backoff_max = 100000 };
+  test_sched_create(&sim, &sched, &results, 0, health);
+  for(int i = 0; i < TEST_SENSORS; i++){
+    hdc1080_sim_inject_fault(sim, i, HDC1080_SIM_FAULT_NACK, HDC1080_SIM_FAULT_FOREVER);
+  }
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_start(sched));
+  vTaskDelay(pdMS_TO_TICKS(TEST_RUN_MS));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_stop(sched));
+  hdc1080_sched_stats_t stats;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_get_stats(sched, TEST_PORT, &stats));
+  // IDLE CYCLES WAIT FOR THE EARLIEST RETRY, A FEW DOZEN AT MOST, NOT A SPIN
+  TEST_ASSERT_GREATER_THAN(0, stats.cycles);
+  TEST_ASSERT_LESS_THAN(TEST_RUN_MS / 4, stats.cycles);
+  for(int i = 0; i < TEST_SENSORS; i++){
+    TEST_ASSERT_EQUAL_INT(0, results.readings[i]);
+    TEST_ASSERT_EQUAL_INT(stats.cycles, results.errors[i]);
+  }
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_delete(sched));
+  hdc1080_sim_delete(sim);
+}
+
+TEST_CASE("deleting the scheduler reports a measurement left in flight", "[hdc1080][sched][sim]"){
+  hdc1080_sim_handle_t sim = NULL;
+  hdc1080_sched_handle_t sched = NULL;
+  test_sched_results_t results;
+  test_sched_create(&sim, &sched, &results, TEST_PERIOD, (hdc1080_health_t){0});
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_start(sched));
+  TEST_ASSERT_EQUAL_HEX(ESP_ERR_INVALID_STATE, hdc1080_sched_delete(sched));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_stop(sched));
+  // THE LAST SENSOR IS STILL ROUTED, START A MEASUREMENT ON IT BEHIND THE SCHEDULER'S BACK
+  hdc1080_handle_t busy = NULL;
+  for(int i = 0; i < TEST_SENSORS; i++){
+    hdc1080_handle_t hdc_handle = hdc1080_sched_get_handle(sched, i);
+    TEST_ASSERT_NOT_NULL(hdc_handle);
+    int64_t ready_at = 0;
+    if(busy == NULL && hdc1080_start_measurement(hdc_handle, &ready_at) == ESP_OK){ busy = hdc_handle; }
+  }
+  TEST_ASSERT_NOT_NULL(busy);
+  TEST_ASSERT_EQUAL_HEX(HDC1080_CONVERTING, hdc1080_sched_delete(sched));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_abort_measurement(busy));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sched_delete(sched));
+  hdc1080_sim_delete(sim);
+}
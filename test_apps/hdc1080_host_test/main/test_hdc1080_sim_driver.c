@@ -0,0 +1,308 @@
+#include <stdatomic.h>
+#include <esp_err.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "unity.h"
+#include "hdc1080.h"
+#include "hdc1080_sim.h"
+
+#define TEST_TIMEOUT            ((TickType_t)200 / portTICK_PERIOD_MS)
+#define TEST_SERIAL_ID          (0x123456789AULL)
+#define TEST_PERIOD             (20000)   /* MICROSECONDS BETWEEN CONTINUOUS SAMPLING SLOTS */
+
+/* ONE SIMULATED BUS WITH ONE HDC1080 AND THE SETTINGS TO DRIVE IT */
+typedef struct TEST_BUS {
+  hdc1080_sim_handle_t sim;
+  int device_id;
+  hdc1080_settings_t settings;
+  hdc1080_config_t config;
+} test_bus_t;
+
+static atomic_int callbacks;
+static atomic_bool in_callback;
+static SemaphoreHandle_t release_callback;
+
+/* -------------------------------------------------------------
+ * @name static void test_bus_create(test_bus_t * bus)
+ * -------------------------------------------------------------
+ * @brief Build a 400kHz simulated bus with one HDC1080 at
+ * HDC1080_I2C_ADDRESS and settings that use it, 14 bit readings
+ * of both channels in one conversion
+ * @param bus -> filled with the bus and the settings
+ */
+static void test_bus_create(test_bus_t * bus){
+  *bus = (test_bus_t){0};
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_create(400000, &bus->sim));
+  hdc1080_sim_device_config_t device_config = {
+    .i2c_address = HDC1080_I2C_ADDRESS,
+    .serial_id = TEST_SERIAL_ID
+  };
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_add_device(bus->sim, &device_config, &bus->device_id));
+  bus->settings.i2c_address = HDC1080_I2C_ADDRESS;
+  bus->settings.timeout_length = TEST_TIMEOUT;
+  hdc1080_sim_get_bus(bus->sim, &bus->settings.bus);
+  bus->config.mode_of_acquisition = HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE;
+  callbacks = 0;
+  in_callback = false;
+}
+
+/* ONE SHOT AND SINK CALLBACK, JUST COUNTS */
+static void test_count_callback(hdc1080_sensor_readings_t sens_readings, void * user_ctx){
+  atomic_fetch_add(&callbacks, 1);
+}
+
+/* SINK CALLBACK THAT HOLDS THE DELIVERY UNTIL THE TEST LETS IT GO */
+static void test_blocking_callback(hdc1080_sensor_readings_t sens_readings, void * user_ctx){
+  in_callback = true;
+  xSemaphoreTake(release_callback, portMAX_DELAY);
+  atomic_fetch_add(&callbacks, 1);
+  in_callback = false;
+}
+
+/* WAIT UP TO timeout_ms FOR count CALLBACKS */
+static void test_wait_callbacks(int count, int timeout_ms){
+  for(int i = 0; i < timeout_ms && atomic_load(&callbacks) < count; i++){ vTaskDelay(pdMS_TO_TICKS(1)); }
+}
+
+TEST_CASE("configure verifies the device and writes the config", "[hdc1080][sim]"){
+  test_bus_t bus;
+  test_bus_create(&bus);
+  bus.config.heater = HDC1080_HEATER_ENABLED;
+  bus.config.humidity_measurement_resolution = HDC1080_HUMIDITY_RESOLUTION_11BIT;
+  hdc1080_handle_t hdc_handle = NULL;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&bus.settings, bus.config, &hdc_handle));
+  hdc1080_config_t read_back = {0};
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_configuration(hdc_handle, &read_back));
+  TEST_ASSERT_EQUAL_HEX8(bus.config.config_register, read_back.config_register);
+  uint64_t serial_id = 0;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_serial_id(hdc_handle, &serial_id));
+  TEST_ASSERT_EQUAL_UINT64(TEST_SERIAL_ID, serial_id);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+  // SETTINGS OUT OF RANGE NEVER REACH THE BUS
+  hdc1080_settings_t bad_settings = bus.settings;
+  bad_settings.sink = HDC1080_SINK_EVENT + 1;
+  TEST_ASSERT_EQUAL_HEX(ESP_ERR_INVALID_ARG, hdc1080_configure(&bad_settings, bus.config, &hdc_handle));
+  bad_settings = bus.settings;
+  bad_settings.completion_mode = HDC1080_COMPLETION_POLL + 1;
+  TEST_ASSERT_EQUAL_HEX(ESP_ERR_INVALID_ARG, hdc1080_configure(&bad_settings, bus.config, &hdc_handle));
+  // NOTHING ANSWERS AT 0x41
+  hdc1080_settings_t empty_settings = bus.settings;
+  empty_settings.i2c_address = HDC1080_I2C_ADDRESS + 1;
+  TEST_ASSERT_NOT_EQUAL(ESP_OK, hdc1080_configure(&empty_settings, bus.config, &hdc_handle));
+  hdc1080_sim_delete(bus.sim);
+}
+
+TEST_CASE("a warm start skips the bring up reads and a bad cache falls back", "[hdc1080][sim]"){
+  test_bus_t bus;
+  test_bus_create(&bus);
+  hdc1080_warm_start_t warm_start = {0};
+  bus.settings.warm_start = &warm_start;
+  hdc1080_handle_t hdc_handle = NULL;
+  hdc1080_sim_stats_t sim_stats;
+  // COLD START, THE IDS AND THE SERIAL ARE READ AND THE CACHE FILLED
+  hdc1080_sim_reset_stats(bus.sim);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&bus.settings, bus.config, &hdc_handle));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+  hdc1080_sim_get_stats(bus.sim, &sim_stats);
+  uint32_t cold_transactions = sim_stats.transactions;
+  TEST_ASSERT_EQUAL_HEX32(HDC1080_WARM_START_MAGIC, warm_start.magic);
+  TEST_ASSERT_EQUAL_UINT64(TEST_SERIAL_ID, warm_start.serial_id);
+  // WARM START WITH THE SAME CONFIG NEVER TOUCHES THE BUS
+  hdc1080_sim_reset_stats(bus.sim);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&bus.settings, bus.config, &hdc_handle));
+  hdc1080_sim_get_stats(bus.sim, &sim_stats);
+  TEST_ASSERT_EQUAL_UINT32(0, sim_stats.transactions);
+  uint64_t serial_id = 0;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_serial_id(hdc_handle, &serial_id));
+  TEST_ASSERT_EQUAL_UINT64(TEST_SERIAL_ID, serial_id);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+  // A CHANGED CONFIG COSTS ONE WRITE
+  hdc1080_config_t heater_config = bus.config;
+  heater_config.heater = HDC1080_HEATER_ENABLED;
+  hdc1080_sim_reset_stats(bus.sim);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&bus.settings, heater_config, &hdc_handle));
+  hdc1080_sim_get_stats(bus.sim, &sim_stats);
+  TEST_ASSERT_EQUAL_UINT32(1, sim_stats.transactions);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+  TEST_ASSERT_EQUAL_HEX8(heater_config.config_register, warm_start.config_register);
+  // A CORRUPT CHECKSUM OR A CACHE OF ANOTHER SENSOR BRINGS IT UP COLD AND REFILLS THE CACHE
+  for(int variant = 0; variant < 2; variant++){
+    if(variant == 0){
+      warm_start.serial_id ^= 1;
+    }else{
+      // THE SIMULATED BUS ANSWERS ON ANY PORT NUMBER, THE CACHE IS FOR PORT 0
+      bus.settings.i2c_port_number = 1;
+    }
+    // THE DEVICE ALREADY HOLDS THE CONFIG, THE COLD PATH READS IT BACK WITHOUT A WRITE
+    hdc1080_sim_reset_stats(bus.sim);
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&bus.settings, heater_config, &hdc_handle));
+    hdc1080_sim_get_stats(bus.sim, &sim_stats);
+    TEST_ASSERT_EQUAL_UINT32(cold_transactions, sim_stats.transactions);
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+    TEST_ASSERT_EQUAL_HEX32(HDC1080_WARM_START_MAGIC, warm_start.magic);
+    TEST_ASSERT_EQUAL_UINT8(bus.settings.i2c_port_number, warm_start.i2c_port_number);
+    TEST_ASSERT_EQUAL_UINT64(TEST_SERIAL_ID, warm_start.serial_id);
+  }
+  // A BRING UP THAT FAILS, HERE THE CONFIG WRITE OF A WARM START, LEAVES NO CACHE BEHIND
+  hdc1080_sim_inject_fault(bus.sim, bus.device_id, HDC1080_SIM_FAULT_NACK, HDC1080_SIM_FAULT_FOREVER);
+  TEST_ASSERT_NOT_EQUAL(ESP_OK, hdc1080_configure(&bus.settings, bus.config, &hdc_handle));
+  TEST_ASSERT_EQUAL_HEX32(0, warm_start.magic);
+  hdc1080_sim_delete(bus.sim);
+}
+
+TEST_CASE("read_sync returns the simulated environment", "[hdc1080][sim]"){
+  test_bus_t bus;
+  test_bus_create(&bus);
+  hdc1080_handle_t hdc_handle = NULL;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&bus.settings, bus.config, &hdc_handle));
+  const float environment[][2] = { { 23.5f, 45.0f }, { -20.0f, 5.0f }, { 80.0f, 95.0f } };
+  for(size_t i = 0; i < sizeof(environment) / sizeof(environment[0]); i++){
+    hdc1080_sim_set_environment(bus.sim, bus.device_id, environment[i][0], environment[i][1]);
+    hdc1080_sensor_readings_t sens_readings = {0};
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT));
+    // ONE 14 BIT STEP IS 0.01°C AND 0.006%RH
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, environment[i][0], sens_readings.temperature);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, environment[i][1], sens_readings.humidity);
+  }
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+  hdc1080_sim_delete(bus.sim);
+}
+
+TEST_CASE("requests made during a conversion share it", "[hdc1080][sim]"){
+  test_bus_t bus;
+  test_bus_create(&bus);
+  hdc1080_handle_t hdc_handle = NULL;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&bus.settings, bus.config, &hdc_handle));
+  hdc1080_sim_reset_stats(bus.sim);
+  for(int i = 0; i < 3; i++){
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_request_readings_cb(hdc_handle, test_count_callback, NULL));
+  }
+  hdc1080_sensor_readings_t sens_readings = {0};
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT));
+  test_wait_callbacks(3, 100);
+  TEST_ASSERT_EQUAL_INT(3, atomic_load(&callbacks));
+  hdc1080_sim_stats_t sim_stats;
+  hdc1080_sim_get_stats(bus.sim, &sim_stats);
+  TEST_ASSERT_EQUAL_UINT32(1, sim_stats.conversions);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+  hdc1080_sim_delete(bus.sim);
+}
+
+TEST_CASE("continuous sampling stays on its grid", "[hdc1080][sim]"){
+  test_bus_t bus;
+  test_bus_create(&bus);
+  bus.settings.sample_buffer_length = 64;
+  for(int worker = 0; worker < 2; worker++){
+    bus.settings.use_worker_task = (worker == 1);
+    hdc1080_handle_t hdc_handle = NULL;
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&bus.settings, bus.config, &hdc_handle));
+    // THE PERIOD HAS TO BE LONGER THAN THE CONVERSION
+    TEST_ASSERT_EQUAL_HEX(ESP_ERR_INVALID_ARG, hdc1080_start_continuous(hdc_handle, hdc1080_conversion_time(bus.config)));
+    // A ONE SHOT REQUEST IN FLIGHT HAS TO FINISH FIRST
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_request_readings_cb(hdc_handle, test_count_callback, NULL));
+    TEST_ASSERT_EQUAL_HEX(HDC1080_CONVERTING, hdc1080_start_continuous(hdc_handle, TEST_PERIOD));
+    test_wait_callbacks(1, 100);
+    TEST_ASSERT_EQUAL_INT(1, atomic_load(&callbacks));
+    int64_t started = esp_timer_get_time();
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_start_continuous(hdc_handle, TEST_PERIOD));
+    TEST_ASSERT_EQUAL_HEX(ESP_ERR_INVALID_STATE, hdc1080_start_continuous(hdc_handle, TEST_PERIOD));
+    TEST_ASSERT_EQUAL_HEX(ESP_ERR_INVALID_STATE, hdc1080_delete(hdc_handle));
+    vTaskDelay(pdMS_TO_TICKS(TEST_PERIOD * 12 / 1000));
+    // EACH RECOVERY HOLDS THE LOCK FOR HDC1080_RESET_TIME, SLOTS THAT COME UP
+    // MEANWHILE START LATE OR ARE SKIPPED, EITHER WAY EVERY SLOT IS ACCOUNTED FOR
+    int64_t busy_from = esp_timer_get_time();
+    int64_t busy_until = busy_from + TEST_PERIOD * 8;
+    while(esp_timer_get_time() < busy_until){
+      if(hdc1080_recover(hdc_handle) == HDC1080_CONVERTING){ vTaskDelay(1); }
+    }
+    vTaskDelay(pdMS_TO_TICKS(TEST_PERIOD * 4 / 1000));
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_stop_continuous(hdc_handle));
+    int64_t slots = (esp_timer_get_time() - started) / TEST_PERIOD;
+    // THE LAST CONVERSION MAY STILL BE FINISHING
+    vTaskDelay(pdMS_TO_TICKS(hdc1080_conversion_time(bus.config) / 1000 + 2));
+    hdc1080_sample_t samples[64];
+    size_t count = hdc1080_drain_samples(hdc_handle, samples, 64);
+    hdc1080_stats_t stats;
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_stats(hdc_handle, &stats));
+    TEST_ASSERT_GREATER_THAN(0, stats.missed_slots);
+    TEST_ASSERT_GREATER_OR_EQUAL(8, count);
+    // THE SLOT THE STOP LANDED IN MAY HAVE GONE EITHER WAY
+    TEST_ASSERT_INT_WITHIN(2, slots, count + stats.missed_slots);
+    TEST_ASSERT_LESS_THAN(TEST_PERIOD + TEST_PERIOD / 4, stats.jitter_max);
+    for(size_t i = 0; i < count; i++){
+      // EVERY SAMPLE STARTED ON A SLOT A WHOLE NUMBER OF PERIODS AFTER THE START
+      int64_t slot = samples[i].timestamp - samples[i].jitter;
+      int64_t periods = (slot - started + TEST_PERIOD / 2) / TEST_PERIOD;
+      TEST_ASSERT_GREATER_OR_EQUAL(1, periods);
+      TEST_ASSERT_INT_WITHIN(TEST_PERIOD / 4, started + periods * TEST_PERIOD, slot);
+      TEST_ASSERT_LESS_THAN((samples[i].timestamp < busy_from) ? TEST_PERIOD / 2 : TEST_PERIOD + TEST_PERIOD / 4, samples[i].jitter);
+      if(i > 0){ TEST_ASSERT_GREATER_THAN(samples[i - 1].timestamp, samples[i].timestamp); }
+      TEST_ASSERT_INT_WITHIN(2, 2500, hdc1080_temperature_centi(samples[i].raw.temperature));
+    }
+    esp_err_t err_ck = HDC1080_CONVERTING;
+    for(int i = 0; i < 100 && err_ck == HDC1080_CONVERTING; i++){
+      err_ck = hdc1080_delete(hdc_handle);
+      if(err_ck == HDC1080_CONVERTING){ vTaskDelay(pdMS_TO_TICKS(1)); }
+    }
+    TEST_ASSERT_EQUAL_HEX(ESP_OK, err_ck);
+    callbacks = 0;
+  }
+  hdc1080_sim_delete(bus.sim);
+}
+
+TEST_CASE("bus faults are reported and the next call goes through", "[hdc1080][sim]"){
+  test_bus_t bus;
+  test_bus_create(&bus);
+  hdc1080_handle_t hdc_handle = NULL;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&bus.settings, bus.config, &hdc_handle));
+  hdc1080_sensor_readings_t sens_readings = {0};
+  hdc1080_sim_inject_fault(bus.sim, bus.device_id, HDC1080_SIM_FAULT_NACK, 1);
+  TEST_ASSERT_EQUAL_HEX(ESP_FAIL, hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT));
+  hdc1080_sim_inject_fault(bus.sim, bus.device_id, HDC1080_SIM_FAULT_TIMEOUT, 1);
+  TEST_ASSERT_EQUAL_HEX(ESP_ERR_TIMEOUT, hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT));
+  // A STUCK BUS FAILS EVERY SENSOR ON IT
+  hdc1080_sim_inject_fault(bus.sim, -1, HDC1080_SIM_FAULT_TIMEOUT, HDC1080_SIM_FAULT_FOREVER);
+  TEST_ASSERT_EQUAL_HEX(ESP_ERR_TIMEOUT, hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT));
+  hdc1080_sim_inject_fault(bus.sim, -1, HDC1080_SIM_FAULT_NONE, 0);
+  // CORRUPTED DATA IS NOT DETECTABLE ON THE BUS, IT SHOWS UP IN THE READINGS
+  hdc1080_sim_inject_fault(bus.sim, bus.device_id, HDC1080_SIM_FAULT_CORRUPT, HDC1080_SIM_FAULT_FOREVER);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_read_sync(hdc_handle, &sens_readings, TEST_TIMEOUT));
+  TEST_ASSERT_FALSE(sens_readings.temperature > 24.0f && sens_readings.temperature < 26.0f);
+  hdc1080_sim_inject_fault(bus.sim, bus.device_id, HDC1080_SIM_FAULT_NONE, 0);
+  hdc1080_stats_t stats;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_stats(hdc_handle, &stats));
+  TEST_ASSERT_EQUAL_UINT32(1, stats.errors_nack);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.errors_timeout);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_delete(hdc_handle));
+  hdc1080_sim_delete(bus.sim);
+}
+
+TEST_CASE("delete waits for a delivery in progress", "[hdc1080][sim]"){
+  test_bus_t bus;
+  test_bus_create(&bus);
+  release_callback = xSemaphoreCreateBinary();
+  TEST_ASSERT_NOT_NULL(release_callback);
+  // NO RING, CONTINUOUS SAMPLES GO TO THE SINK CALLBACK
+  bus.settings.callback = test_blocking_callback;
+  hdc1080_handle_t hdc_handle = NULL;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&bus.settings, bus.config, &hdc_handle));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_start_continuous(hdc_handle, TEST_PERIOD));
+  for(int i = 0; i < 200 && !in_callback; i++){ vTaskDelay(pdMS_TO_TICKS(1)); }
+  TEST_ASSERT_TRUE(in_callback);
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_stop_continuous(hdc_handle));
+  TEST_ASSERT_EQUAL_HEX(HDC1080_CONVERTING, hdc1080_delete(hdc_handle));
+  xSemaphoreGive(release_callback);
+  esp_err_t err_ck = HDC1080_CONVERTING;
+  for(int i = 0; i < 100 && err_ck == HDC1080_CONVERTING; i++){
+    err_ck = hdc1080_delete(hdc_handle);
+    if(err_ck == HDC1080_CONVERTING){ vTaskDelay(pdMS_TO_TICKS(1)); }
+  }
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, err_ck);
+  TEST_ASSERT_EQUAL_INT(1, atomic_load(&callbacks));
+  vSemaphoreDelete(release_callback);
+  hdc1080_sim_delete(bus.sim);
+}
@@ -0,0 +1,233 @@
+#include <stdlib.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "unity.h"
+#include "hdc1080.h"
+#include "hdc1080_sim.h"
+#include "hdc1080_stream.h"
+
+#define TEST_TIMEOUT            ((TickType_t)200 / portTICK_PERIOD_MS)
+#define TEST_SERIAL_ID          (0x1ABCDEF0123ULL)
+#define TEST_CONFIG_14BIT       (0x10)    /* BOTH CHANNELS, 14 BIT */
+#define TEST_CONFIG_11BIT       (0x15)    /* BOTH CHANNELS, 11 BIT TEMPERATURE AND HUMIDITY */
+#define TEST_SAMPLES            (1000)
+#define TEST_FRAME_SAMPLES      (64)      /* SMALL FRAMES SO THE ROUND TRIP CROSSES MANY OF THEM */
+#define TEST_PERIOD             (20000)   /* MICROSECONDS BETWEEN CONTINUOUS SAMPLING SLOTS */
+
+static hdc1080_stream_sample_t samples_in[TEST_SAMPLES];
+static hdc1080_stream_sample_t samples_out[TEST_SAMPLES];
+static uint8_t stream[TEST_SAMPLES * HDC1080_STREAM_MAX_SAMPLE_LEN];
+
+/* -------------------------------------------------------------
+ * @name static void test_fill_samples(uint16_t code_mask)
+ * -------------------------------------------------------------
+ * @brief A 1Hz random walk with timing jitter, the codes carry 0s
+ * in the low bits like the HDC1080 does at the resolution
+ * @param code_mask -> the bits the resolution keeps
+ */
+static void test_fill_samples(uint16_t code_mask){
+  srand(1080);
+  int64_t timestamp = 1000000;
+  int temperature = 26000;
+  int humidity = 30000;
+  for(int i = 0; i < TEST_SAMPLES; i++){
+    timestamp += 1000000 + (rand() % 200) - 100;
+    temperature += ((rand() % 3) - 1) * 64;
+    humidity += ((rand() % 5) - 2) * 64;
+    // THE OCCASIONAL BIG STEP TAKES THE WIDE VARINTS
+    if(i % 97 == 0){ temperature += 8000; humidity -= 8000; }
+    samples_in[i] = (hdc1080_stream_sample_t){
+      .timestamp = timestamp,
+      .temperature = (uint16_t)temperature & code_mask,
+      .humidity = (uint16_t)humidity & code_mask
+    };
+  }
+}
+
+/* COMPARE FIELD BY FIELD, THE SAMPLE HAS PADDING */
+static void test_assert_samples(const hdc1080_stream_sample_t * expected, const hdc1080_stream_sample_t * actual, size_t count){
+  for(size_t i = 0; i < count; i++){
+    TEST_ASSERT_EQUAL_INT64(expected[i].timestamp, actual[i].timestamp);
+    TEST_ASSERT_EQUAL_HEX16(expected[i].temperature, actual[i].temperature);
+    TEST_ASSERT_EQUAL_HEX16(expected[i].humidity, actual[i].humidity);
+  }
+}
+
+/* DECODE EVERYTHING INTO samples_out, RETURNS THE SAMPLE COUNT AND LEAVES THE LAST RESULT IN result */
+static size_t test_decode_all(hdc1080_stream_decoder_t * decoder, const uint8_t * data, size_t length, int * result){
+  hdc1080_stream_decoder_init(decoder, data, length);
+  size_t count = 0;
+  hdc1080_stream_sample_t sample;
+  while((*result = hdc1080_stream_decode(decoder, &sample)) == HDC1080_STREAM_OK){
+    if(count < TEST_SAMPLES){ samples_out[count] = sample; }
+    count++;
+  }
+  return count;
+}
+
+TEST_CASE("stream round trip keeps every sample", "[hdc1080][stream]"){
+  const uint8_t configs[] = { TEST_CONFIG_14BIT, TEST_CONFIG_11BIT };
+  const uint16_t masks[] = { 0xFFFC, 0xFFE0 };
+  size_t lengths[2];
+  for(int c = 0; c < 2; c++){
+    test_fill_samples(masks[c]);
+    hdc1080_stream_encoder_t encoder;
+    hdc1080_stream_encoder_init(&encoder, stream, sizeof(stream), TEST_SERIAL_ID, configs[c], TEST_FRAME_SAMPLES);
+    TEST_ASSERT_EQUAL_size_t(TEST_SAMPLES, hdc1080_stream_encode(&encoder, samples_in, TEST_SAMPLES));
+    lengths[c] = hdc1080_stream_finish(&encoder);
+    TEST_ASSERT_EQUAL_UINT8(HDC1080_STREAM_SYNC, stream[0]);
+    hdc1080_stream_decoder_t decoder;
+    int result = HDC1080_STREAM_OK;
+    TEST_ASSERT_EQUAL_size_t(TEST_SAMPLES, test_decode_all(&decoder, stream, lengths[c], &result));
+    TEST_ASSERT_EQUAL_INT(HDC1080_STREAM_END, result);
+    test_assert_samples(samples_in, samples_out, TEST_SAMPLES);
+    TEST_ASSERT_EQUAL_UINT64(TEST_SERIAL_ID, decoder.sensor_id);
+    TEST_ASSERT_EQUAL_HEX8(configs[c], decoder.config_register);
+  }
+  // THE SAME WALK AT 11 BITS DROPS 3 MORE BITS PER CODE
+  TEST_ASSERT_LESS_THAN(lengths[0], lengths[1]);
+}
+
+TEST_CASE("stream cost per sample matches hdc1080_stream.h", "[hdc1080][stream]"){
+  // A STEADY PERIOD AND A STEADY ROOM, THEN THE JITTERED RANDOM WALK
+  for(int i = 0; i < TEST_SAMPLES; i++){
+    samples_in[i] = (hdc1080_stream_sample_t){ .timestamp = 1000000 * (int64_t)(i + 1), .temperature = 26000 & 0xFFFC, .humidity = 30000 & 0xFFFC };
+  }
+  hdc1080_stream_encoder_t encoder;
+  hdc1080_stream_encoder_init(&encoder, stream, sizeof(stream), TEST_SERIAL_ID, TEST_CONFIG_14BIT, 0);
+  hdc1080_stream_encode(&encoder, samples_in, TEST_SAMPLES);
+  TEST_ASSERT_LESS_OR_EQUAL(TEST_SAMPLES * 31 / 10, hdc1080_stream_finish(&encoder));
+  test_fill_samples(0xFFFC);
+  hdc1080_stream_encoder_init(&encoder, stream, sizeof(stream), TEST_SERIAL_ID, TEST_CONFIG_14BIT, 0);
+  hdc1080_stream_encode(&encoder, samples_in, TEST_SAMPLES);
+  TEST_ASSERT_LESS_OR_EQUAL(TEST_SAMPLES * 36 / 10, hdc1080_stream_finish(&encoder));
+}
+
+TEST_CASE("stream decoder stops at a cut and skips a bad frame", "[hdc1080][stream]"){
+  test_fill_samples(0xFFFC);
+  hdc1080_stream_encoder_t encoder;
+  hdc1080_stream_encoder_init(&encoder, stream, sizeof(stream), TEST_SERIAL_ID, TEST_CONFIG_14BIT, TEST_FRAME_SAMPLES);
+  hdc1080_stream_encode(&encoder, samples_in, TEST_SAMPLES);
+  size_t length = hdc1080_stream_finish(&encoder);
+  hdc1080_stream_decoder_t decoder;
+  int result = HDC1080_STREAM_OK;
+  // CUT INSIDE THE THIRD FRAME, THE FIRST TWO COME OUT WHOLE
+  size_t first_frames = 0;
+  hdc1080_stream_decoder_init(&decoder, stream, length);
+  while(first_frames < 2 * TEST_FRAME_SAMPLES){
+    TEST_ASSERT_EQUAL_INT(HDC1080_STREAM_OK, hdc1080_stream_decode(&decoder, &samples_out[0]));
+    first_frames++;
+  }
+  // BETWEEN FRAMES offset IS THE START OF THE NEXT ONE
+  size_t third_frame = decoder.offset;
+  size_t count = test_decode_all(&decoder, stream, third_frame + 20, &result);
+  TEST_ASSERT_EQUAL_INT(HDC1080_STREAM_TRUNCATED, result);
+  TEST_ASSERT_EQUAL_size_t(2 * TEST_FRAME_SAMPLES, count);
+  TEST_ASSERT_EQUAL_size_t(third_frame, decoder.offset);
+  // DECODING FROM offset WITH THE REST OF THE DATA PICKS UP WHERE IT STOPPED
+  count = test_decode_all(&decoder, stream + third_frame, length - third_frame, &result);
+  TEST_ASSERT_EQUAL_INT(HDC1080_STREAM_END, result);
+  TEST_ASSERT_EQUAL_size_t(TEST_SAMPLES - (2 * TEST_FRAME_SAMPLES), count);
+  test_assert_samples(&samples_in[2 * TEST_FRAME_SAMPLES], samples_out, count);
+  // A FLIPPED BYTE IN THE THIRD FRAME PAYLOAD LOSES THAT FRAME ONLY
+  stream[third_frame + HDC1080_STREAM_HEADER_LEN + 5] ^= 0x55;
+  hdc1080_stream_decoder_init(&decoder, stream, length);
+  size_t decoded = 0;
+  int corrupt = 0;
+  while((result = hdc1080_stream_decode(&decoder, &samples_out[decoded])) != HDC1080_STREAM_END){
+    TEST_ASSERT_NOT_EQUAL(HDC1080_STREAM_TRUNCATED, result);
+    if(result == HDC1080_STREAM_CORRUPT){
+      corrupt++;
+      continue;
+    }
+    // NOTHING FROM THE BAD FRAME MAY COME OUT
+    size_t index = (decoded < 2 * TEST_FRAME_SAMPLES) ? decoded : decoded + TEST_FRAME_SAMPLES;
+    test_assert_samples(&samples_in[index], &samples_out[decoded], 1);
+    decoded++;
+  }
+  // THE DECODER RESYNCS BYTE BY BYTE, IT MAY REPORT THE BAD FRAME MORE THAN ONCE
+  TEST_ASSERT_GREATER_OR_EQUAL(1, corrupt);
+  TEST_ASSERT_EQUAL_size_t(TEST_SAMPLES - TEST_FRAME_SAMPLES, decoded);
+}
+
+TEST_CASE("stream encoder stops cleanly when the buffer is full", "[hdc1080][stream]"){
+  test_fill_samples(0xFFFC);
+  uint8_t small[200];
+  hdc1080_stream_encoder_t encoder;
+  hdc1080_stream_encoder_init(&encoder, small, sizeof(small), TEST_SERIAL_ID, TEST_CONFIG_14BIT, 0);
+  size_t added = hdc1080_stream_encode(&encoder, samples_in, TEST_SAMPLES);
+  TEST_ASSERT_GREATER_THAN(0, added);
+  TEST_ASSERT_LESS_THAN(TEST_SAMPLES, added);
+  TEST_ASSERT_FALSE(hdc1080_stream_put(&encoder, &samples_in[added]));
+  size_t length = hdc1080_stream_finish(&encoder);
+  TEST_ASSERT_LESS_OR_EQUAL(sizeof(small), length);
+  // WHAT WAS TAKEN IS A COMPLETE STREAM
+  hdc1080_stream_decoder_t decoder;
+  int result = HDC1080_STREAM_OK;
+  TEST_ASSERT_EQUAL_size_t(added, test_decode_all(&decoder, small, length, &result));
+  TEST_ASSERT_EQUAL_INT(HDC1080_STREAM_END, result);
+  test_assert_samples(samples_in, samples_out, added);
+}
+
+/* SLOW DRIFT SO THE CONTINUOUS SAMPLES ARE NOT ALL THE SAME */
+static void test_drift_source(void * source_ctx, int64_t now, float * celsius, float * humidity){
+  *celsius = 20.0f + (float)(now % 1000000) / 100000.0f;
+  *humidity = 60.0f - (float)(now % 1000000) / 50000.0f;
+}
+
+TEST_CASE("stream round trip of continuous samples from the driver", "[hdc1080][stream][sim]"){
+  hdc1080_sim_handle_t sim = NULL;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_create(400000, &sim));
+  hdc1080_sim_device_config_t device_config = {
+    .i2c_address = HDC1080_I2C_ADDRESS,
+    .serial_id = TEST_SERIAL_ID
+  };
+  int device_id = 0;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_add_device(sim, &device_config, &device_id));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_sim_set_source(sim, device_id, test_drift_source, NULL));
+  hdc1080_settings_t settings = {
+    .i2c_address = HDC1080_I2C_ADDRESS,
+    .timeout_length = TEST_TIMEOUT,
+    .sample_buffer_length = 32
+  };
+  hdc1080_sim_get_bus(sim, &settings.bus);
+  hdc1080_config_t config = {
+    .mode_of_acquisition = HDC1080_ACQUISITION_HUMIDITY_AND_TEMPERATURE,
+    .humidity_measurement_resolution = HDC1080_HUMIDITY_RESOLUTION_11BIT
+  };
+  hdc1080_handle_t hdc_handle = NULL;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_configure(&settings, config, &hdc_handle));
+  uint64_t serial_id = 0;
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_serial_id(hdc_handle, &serial_id));
+  hdc1080_config_t read_back = {0};
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_get_configuration(hdc_handle, &read_back));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_start_continuous(hdc_handle, TEST_PERIOD));
+  vTaskDelay(pdMS_TO_TICKS(TEST_PERIOD * 12 / 1000));
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, hdc1080_stop_continuous(hdc_handle));
+  hdc1080_sample_t samples[32];
+  size_t count = hdc1080_drain_samples(hdc_handle, samples, 32);
+  TEST_ASSERT_GREATER_OR_EQUAL(8, count);
+  hdc1080_stream_encoder_t encoder;
+  hdc1080_stream_encoder_init(&encoder, stream, sizeof(stream), serial_id, read_back.config_register, 4);
+  TEST_ASSERT_EQUAL_size_t(count, hdc1080_stream_encode_samples(&encoder, samples, count));
+  size_t length = hdc1080_stream_finish(&encoder);
+  hdc1080_stream_decoder_t decoder;
+  int result = HDC1080_STREAM_OK;
+  TEST_ASSERT_EQUAL_size_t(count, test_decode_all(&decoder, stream, length, &result));
+  TEST_ASSERT_EQUAL_INT(HDC1080_STREAM_END, result);
+  TEST_ASSERT_EQUAL_UINT64(TEST_SERIAL_ID, decoder.sensor_id);
+  TEST_ASSERT_EQUAL_HEX8(read_back.config_register, decoder.config_register);
+  for(size_t i = 0; i < count; i++){
+    TEST_ASSERT_EQUAL_INT64(samples[i].timestamp, samples_out[i].timestamp);
+    TEST_ASSERT_EQUAL_HEX16(samples[i].raw.temperature, samples_out[i].temperature);
+    TEST_ASSERT_EQUAL_HEX16(samples[i].raw.humidity, samples_out[i].humidity);
+  }
+  // THE LAST CONVERSION MAY STILL BE FINISHING
+  esp_err_t err_ck = HDC1080_CONVERTING;
+  for(int i = 0; i < 100 && err_ck == HDC1080_CONVERTING; i++){
+    err_ck = hdc1080_delete(hdc_handle);
+    if(err_ck == HDC1080_CONVERTING){ vTaskDelay(pdMS_TO_TICKS(1)); }
+  }
+  TEST_ASSERT_EQUAL_HEX(ESP_OK, err_ck);
+  hdc1080_sim_delete(sim);
+}